@@ -0,0 +1,380 @@
+#include "ECS/World.hpp"
+#include "Core/JobSystem.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Orchard;
+using namespace Orchard::ECS;
+
+namespace {
+
+struct Position { float x, y, z; };
+struct Velocity { float x, y, z; };
+struct Health { float value; };
+struct Frozen {};
+struct Burning : SparseComponent { float remaining; };
+
+template<int N>
+struct Fragment {};
+
+constexpr size_t FRAGMENT_TAGS = 6;
+constexpr size_t FRAGMENT_ARCHETYPES = size_t(1) << FRAGMENT_TAGS;
+
+volatile float g_Sink = 0.0f;
+
+struct Options {
+    size_t maxEntities = 10000000;
+    size_t maxStructuralEntities = 1000000;
+    size_t repetitions = 5;
+    std::string filter;
+    std::string output;
+};
+
+struct BenchmarkResult {
+    std::string name;
+    size_t entities;
+    size_t operations;
+    double minMilliseconds;
+    double medianMilliseconds;
+};
+
+struct Fixture {
+    std::unique_ptr<World> world = std::make_unique<World>();
+    std::vector<Entity> entities;
+};
+
+class BenchmarkRunner {
+public:
+    explicit BenchmarkRunner(const Options& options) : m_Options(options) {}
+    
+    template<typename Setup, typename Body>
+    void Run(const std::string& name, size_t entities, size_t operations, Setup&& setup, Body&& body) {
+        if (!m_Options.filter.empty() && name.find(m_Options.filter) == std::string::npos) return;
+        
+        std::vector<double> samples;
+        for (size_t r = 0; r < m_Options.repetitions; ++r) {
+            Fixture fixture = setup();
+            
+            auto start = std::chrono::steady_clock::now();
+            body(fixture);
+            auto end = std::chrono::steady_clock::now();
+            
+            samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        
+        std::sort(samples.begin(), samples.end());
+        BenchmarkResult result{ name, entities, operations, samples.front(), samples[samples.size() / 2] };
+        m_Results.push_back(result);
+        
+        std::fprintf(stderr, "%-32s %10zu entities %12.3f ms %10.2f ns/op\n", name.c_str(), entities,
+                     result.medianMilliseconds, result.medianMilliseconds * 1e6 / std::max<size_t>(operations, 1));
+    }
+    
+    const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+    
+private:
+    const Options& m_Options;
+    std::vector<BenchmarkResult> m_Results;
+};
+
+Fixture CreateMovers(size_t count) {
+    Fixture fixture;
+    fixture.entities = fixture.world->CreateEntities(count, Position{ 0.0f, 0.0f, 0.0f }, Velocity{ 1.0f, 2.0f, 3.0f });
+    return fixture;
+}
+
+template<size_t... I>
+std::vector<ComponentTypeID> GetFragmentSignature(size_t mask, std::index_sequence<I...>) {
+    std::vector<ComponentTypeID> signature{ ComponentRegistry::GetTypeID<Position>(), ComponentRegistry::GetTypeID<Velocity>() };
+    ((mask & (size_t(1) << I) ? signature.push_back(ComponentRegistry::GetTypeID<Fragment<I>>()) : void()), ...);
+    return signature;
+}
+
+Fixture CreateFragmented(size_t count) {
+    Fixture fixture;
+    Position position{ 0.0f, 0.0f, 0.0f };
+    Velocity velocity{ 1.0f, 2.0f, 3.0f };
+    
+    for (size_t mask = 0; mask < FRAGMENT_ARCHETYPES; ++mask) {
+        size_t batch = count / FRAGMENT_ARCHETYPES + (mask < count % FRAGMENT_ARCHETYPES ? 1 : 0);
+        auto signature = GetFragmentSignature(mask, std::make_index_sequence<FRAGMENT_TAGS>{});
+        std::vector<const void*> values(signature.size(), nullptr);
+        values[0] = &position;
+        values[1] = &velocity;
+        
+        auto entities = fixture.world->CreateEntities(batch, signature, values);
+        fixture.entities.insert(fixture.entities.end(), entities.begin(), entities.end());
+    }
+    return fixture;
+}
+
+std::vector<Entity> Shuffled(std::vector<Entity> entities) {
+    std::mt19937_64 random(0x0C4A4D);
+    std::shuffle(entities.begin(), entities.end(), random);
+    return entities;
+}
+
+void RunStructuralBenchmarks(BenchmarkRunner& runner, size_t count) {
+    runner.Run("create_entity_add_components", count, count,
+        [] { return Fixture(); },
+        [count](Fixture& fixture) {
+            for (size_t i = 0; i < count; ++i) {
+                Entity entity = fixture.world->CreateEntity();
+                fixture.world->AddComponent(entity, Position{ 0.0f, 0.0f, 0.0f });
+                fixture.world->AddComponent(entity, Velocity{ 1.0f, 2.0f, 3.0f });
+            }
+        });
+    
+    runner.Run("create_entities_bulk", count, count,
+        [] { return Fixture(); },
+        [count](Fixture& fixture) {
+            fixture.entities = fixture.world->CreateEntities(count, Position{ 0.0f, 0.0f, 0.0f }, Velocity{ 1.0f, 2.0f, 3.0f });
+        });
+    
+    runner.Run("destroy_entity", count, count,
+        [count] { return CreateMovers(count); },
+        [](Fixture& fixture) {
+            for (Entity entity : fixture.entities) {
+                fixture.world->DestroyEntity(entity);
+            }
+        });
+    
+    runner.Run("destroy_entities_bulk", count, count,
+        [count] { return CreateMovers(count); },
+        [](Fixture& fixture) {
+            fixture.world->DestroyEntities(fixture.entities);
+        });
+    
+    runner.Run("add_remove_component", count, count * 2,
+        [count] { return CreateMovers(count); },
+        [](Fixture& fixture) {
+            for (Entity entity : fixture.entities) {
+                fixture.world->AddComponent(entity, Health{ 100.0f });
+            }
+            for (Entity entity : fixture.entities) {
+                fixture.world->RemoveComponent<Health>(entity);
+            }
+        });
+    
+    runner.Run("add_remove_tag", count, count * 2,
+        [count] { return CreateMovers(count); },
+        [](Fixture& fixture) {
+            for (Entity entity : fixture.entities) {
+                fixture.world->AddComponent(entity, Frozen{});
+            }
+            for (Entity entity : fixture.entities) {
+                fixture.world->RemoveComponent<Frozen>(entity);
+            }
+        });
+    
+    runner.Run("add_remove_sparse", count, count * 2,
+        [count] { return CreateMovers(count); },
+        [](Fixture& fixture) {
+            for (Entity entity : fixture.entities) {
+                fixture.world->AddComponent(entity, Burning{ {}, 1.0f });
+            }
+            for (Entity entity : fixture.entities) {
+                fixture.world->RemoveComponent<Burning>(entity);
+            }
+        });
+    
+    runner.Run("fragmented_add_remove_tag", count, count * 2,
+        [count] { return CreateFragmented(count); },
+        [](Fixture& fixture) {
+            for (Entity entity : fixture.entities) {
+                fixture.world->AddComponent(entity, Frozen{});
+            }
+            for (Entity entity : fixture.entities) {
+                fixture.world->RemoveComponent<Frozen>(entity);
+            }
+        });
+}
+
+void RunAccessBenchmarks(BenchmarkRunner& runner, JobSystem& jobSystem, size_t count) {
+    runner.Run("get_component_random", count, count,
+        [count] {
+            Fixture fixture = CreateMovers(count);
+            fixture.entities = Shuffled(std::move(fixture.entities));
+            return fixture;
+        },
+        [](Fixture& fixture) {
+            float sum = 0.0f;
+            for (Entity entity : fixture.entities) {
+                sum += static_cast<const World&>(*fixture.world).GetComponent<Position>(entity)->x;
+            }
+            g_Sink = sum;
+        });
+    
+    runner.Run("query_foreach", count, count,
+        [count] { return CreateMovers(count); },
+        [](Fixture& fixture) {
+            fixture.world->ForEach<Position, const Velocity>([](Entity, Position& position, const Velocity& velocity) {
+                position.x += velocity.x;
+                position.y += velocity.y;
+                position.z += velocity.z;
+            });
+        });
+    
+    runner.Run("query_foreach_chunk", count, count,
+        [count] { return CreateMovers(count); },
+        [](Fixture& fixture) {
+            fixture.world->GetQuery<Position, const Velocity>().ForEachChunk(
+                [](size_t n, const Entity*, Position* positions, const Velocity* velocities) {
+                    for (size_t i = 0; i < n; ++i) {
+                        positions[i].x += velocities[i].x;
+                        positions[i].y += velocities[i].y;
+                        positions[i].z += velocities[i].z;
+                    }
+                });
+        });
+    
+    runner.Run("query_parallel_chunk", count, count,
+        [count] { return CreateMovers(count); },
+        [&jobSystem](Fixture& fixture) {
+            fixture.world->GetQuery<Position, const Velocity>().ParallelForEachChunk(jobSystem,
+                [](size_t n, const Entity*, Position* positions, const Velocity* velocities) {
+                    for (size_t i = 0; i < n; ++i) {
+                        positions[i].x += velocities[i].x;
+                        positions[i].y += velocities[i].y;
+                        positions[i].z += velocities[i].z;
+                    }
+                });
+        });
+    
+    runner.Run("query_fragmented_64", count, count,
+        [count] { return CreateFragmented(count); },
+        [](Fixture& fixture) {
+            fixture.world->ForEach<Position, const Velocity>([](Entity, Position& position, const Velocity& velocity) {
+                position.x += velocity.x;
+                position.y += velocity.y;
+                position.z += velocity.z;
+            });
+        });
+    
+    runner.Run("query_sparse_mixed", count, count,
+        [count] {
+            Fixture fixture = CreateMovers(count);
+            for (size_t i = 0; i < fixture.entities.size(); i += 8) {
+                fixture.world->AddComponent(fixture.entities[i], Burning{ {}, 1.0f });
+            }
+            return fixture;
+        },
+        [](Fixture& fixture) {
+            fixture.world->ForEach<Position, Burning>([](Entity, Position& position, Burning& burning) {
+                burning.remaining -= 0.016f;
+                position.y += burning.remaining;
+            });
+        });
+}
+
+std::string EscapeJson(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string FormatJson(const Options& options, const std::vector<BenchmarkResult>& results) {
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"suite\": \"OrchardEngine ECS\",\n";
+#if defined(__clang__)
+    json << "  \"compiler\": \"clang " << __clang_major__ << "." << __clang_minor__ << "." << __clang_patchlevel__ << "\",\n";
+#elif defined(__GNUC__)
+    json << "  \"compiler\": \"gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "." << __GNUC_PATCHLEVEL__ << "\",\n";
+#endif
+    json << "  \"chunkSize\": " << CHUNK_SIZE << ",\n";
+    json << "  \"repetitions\": " << options.repetitions << ",\n";
+    json << "  \"results\": [\n";
+    
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        double nsPerOp = result.medianMilliseconds * 1e6 / std::max<size_t>(result.operations, 1);
+        
+        json << "    { \"name\": \"" << EscapeJson(result.name) << "\""
+             << ", \"entities\": " << result.entities
+             << ", \"operations\": " << result.operations
+             << ", \"minMs\": " << result.minMilliseconds
+             << ", \"medianMs\": " << result.medianMilliseconds
+             << ", \"nsPerOp\": " << nsPerOp
+             << ", \"opsPerSecond\": " << (nsPerOp > 0.0 ? 1e9 / nsPerOp : 0.0)
+             << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    
+    json << "  ]\n";
+    json << "}\n";
+    return json.str();
+}
+
+bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        
+        if (arg == "--max-entities" && hasValue) {
+            options.maxEntities = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--max-structural-entities" && hasValue) {
+            options.maxStructuralEntities = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--repetitions" && hasValue) {
+            options.repetitions = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--output" && hasValue) {
+            options.output = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--max-entities N] [--max-structural-entities N]"
+                      << " [--repetitions N] [--filter NAME] [--output FILE.json]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+    
+    JobSystem jobSystem;
+    jobSystem.Initialize();
+    
+    BenchmarkRunner runner(options);
+    for (size_t count = 1000; count <= options.maxEntities; count *= 10) {
+        if (count <= options.maxStructuralEntities) {
+            RunStructuralBenchmarks(runner, count);
+        }
+        RunAccessBenchmarks(runner, jobSystem, count);
+    }
+    
+    jobSystem.Shutdown();
+    
+    std::string json = FormatJson(options, runner.GetResults());
+    if (options.output.empty()) {
+        std::cout << json;
+        return 0;
+    }
+    
+    std::ofstream file(options.output);
+    if (!file) {
+        std::cerr << "Failed to open " << options.output << " for writing" << std::endl;
+        return 1;
+    }
+    file << json;
+    return 0;
+}
@@ -5,6 +5,8 @@
 #include "ResourceManager.hpp"
 #include "SceneManager.hpp"
 #include "EventSystem.hpp"
+#include "JobSystem.hpp"
+#include "Memory.hpp"
 #include <chrono>
 #include <thread>
 #include <iostream>
@@ -26,6 +28,12 @@ bool Engine::Initialize(const std::string& appName, uint32_t width, uint32_t hei
     
     m_EventSystem = std::make_unique<EventSystem>();
     
+    m_JobSystem = std::make_unique<JobSystem>();
+    if (!m_JobSystem->Initialize()) {
+        std::cerr << "Failed to initialize Job System" << std::endl;
+        return false;
+    }
+    
     m_ResourceManager = std::make_unique<ResourceManager>();
     if (!m_ResourceManager->Initialize()) {
         std::cerr << "Failed to initialize Resource Manager" << std::endl;
@@ -71,6 +79,7 @@ void Engine::Shutdown() {
     m_PhysicsWorld->Shutdown();
     m_Renderer->Shutdown();
     m_ResourceManager->Shutdown();
+    m_JobSystem->Shutdown();
     
     m_SceneManager.reset();
     m_AudioEngine.reset();
@@ -78,6 +87,7 @@ void Engine::Shutdown() {
     m_Renderer.reset();
     m_ResourceManager.reset();
     m_EventSystem.reset();
+    m_JobSystem.reset();
     
     m_Initialized = false;
     std::cout << "Orchard Engine shut down successfully." << std::endl;
@@ -96,6 +106,8 @@ void Engine::Run() {
     const double fixedTimeStep = 1.0 / 60.0;
     
     while (m_Running) {
+        Memory::FrameAllocator::BeginFrame();
+        
         auto currentTime = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> elapsed = currentTime - lastTime;
         lastTime = currentTime;
@@ -13,6 +13,7 @@ class AudioEngine;
 class ResourceManager;
 class SceneManager;
 class EventSystem;
+class JobSystem;
 
 class Engine {
 public:
@@ -33,6 +34,7 @@ public:
     ResourceManager* GetResourceManager() const { return m_ResourceManager.get(); }
     SceneManager* GetSceneManager() const { return m_SceneManager.get(); }
     EventSystem* GetEventSystem() const { return m_EventSystem.get(); }
+    JobSystem* GetJobSystem() const { return m_JobSystem.get(); }
     
     double GetDeltaTime() const { return m_DeltaTime; }
     double GetTotalTime() const { return m_TotalTime; }
@@ -55,6 +57,7 @@ private:
     std::unique_ptr<ResourceManager> m_ResourceManager;
     std::unique_ptr<SceneManager> m_SceneManager;
     std::unique_ptr<EventSystem> m_EventSystem;
+    std::unique_ptr<JobSystem> m_JobSystem;
     
     double m_DeltaTime = 0.0;
     double m_TotalTime = 0.0;
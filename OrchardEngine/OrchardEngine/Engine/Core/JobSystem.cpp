@@ -0,0 +1,167 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace Orchard {
+
+static thread_local const JobSystem* t_CurrentJobSystem = nullptr;
+static thread_local uint32_t t_CurrentQueueIndex = 0;
+
+JobSystem::~JobSystem() {
+    Shutdown();
+}
+
+bool JobSystem::Initialize(uint32_t workerCount) {
+    if (m_Running) {
+        std::cerr << "Job System already initialized!" << std::endl;
+        return false;
+    }
+    
+    if (workerCount == 0) {
+        uint32_t hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+    }
+    
+    m_Queues.clear();
+    for (uint32_t i = 0; i <= workerCount; ++i) {
+        m_Queues.push_back(std::make_unique<WorkQueue>());
+    }
+    
+    m_Running = true;
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    }
+    
+    std::cout << "Job System initialized with " << workerCount << " workers" << std::endl;
+    return true;
+}
+
+void JobSystem::Shutdown() {
+    if (!m_Running) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+        m_Running = false;
+    }
+    m_SleepCondition.notify_all();
+    
+    for (auto& worker : m_Workers) {
+        worker.join();
+    }
+    m_Workers.clear();
+    m_Queues.clear();
+    m_QueuedJobs = 0;
+}
+
+uint32_t JobSystem::GetCurrentQueueIndex() const {
+    if (t_CurrentJobSystem == this) {
+        return t_CurrentQueueIndex;
+    }
+    return static_cast<uint32_t>(m_Workers.size());
+}
+
+void JobSystem::Schedule(Job job, JobCounter* counter) {
+    if (m_Queues.empty()) {
+        job();
+        return;
+    }
+    
+    if (counter) {
+        counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    
+    WorkQueue& queue = *m_Queues[GetCurrentQueueIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(QueuedJob{ std::move(job), counter });
+    }
+    
+    m_QueuedJobs.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_SleepMutex);
+    }
+    m_SleepCondition.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    uint32_t queueIndex = GetCurrentQueueIndex();
+    while (!counter.IsDone()) {
+        if (!TryRunJob(queueIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void JobSystem::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func) {
+    if (count == 0) return;
+    
+    grainSize = std::max<size_t>(grainSize, 1);
+    if (m_Workers.empty() || count <= grainSize) {
+        func(0, count);
+        return;
+    }
+    
+    JobCounter counter;
+    for (size_t begin = 0; begin < count; begin += grainSize) {
+        size_t end = std::min(begin + grainSize, count);
+        Schedule([&func, begin, end]() { func(begin, end); }, &counter);
+    }
+    Wait(counter);
+}
+
+void JobSystem::WorkerLoop(uint32_t workerIndex) {
+    t_CurrentJobSystem = this;
+    t_CurrentQueueIndex = workerIndex;
+    
+    while (m_Running) {
+        if (TryRunJob(workerIndex)) continue;
+        
+        std::unique_lock<std::mutex> lock(m_SleepMutex);
+        m_SleepCondition.wait(lock, [this]() {
+            return !m_Running || m_QueuedJobs.load(std::memory_order_acquire) > 0;
+        });
+    }
+    
+    t_CurrentJobSystem = nullptr;
+}
+
+bool JobSystem::TryRunJob(uint32_t queueIndex) {
+    QueuedJob queued;
+    if (!PopLocal(queueIndex, queued) && !Steal(queueIndex, queued)) {
+        return false;
+    }
+    
+    m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+    queued.job();
+    
+    if (queued.counter) {
+        queued.counter->m_Pending.fetch_sub(1, std::memory_order_release);
+    }
+    return true;
+}
+
+bool JobSystem::PopLocal(uint32_t queueIndex, QueuedJob& out) {
+    WorkQueue& queue = *m_Queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) return false;
+    
+    out = std::move(queue.jobs.back());
+    queue.jobs.pop_back();
+    return true;
+}
+
+bool JobSystem::Steal(uint32_t thiefIndex, QueuedJob& out) {
+    size_t queueCount = m_Queues.size();
+    for (size_t offset = 1; offset < queueCount; ++offset) {
+        WorkQueue& victim = *m_Queues[(thiefIndex + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty()) continue;
+        
+        out = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+        return true;
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Orchard {
+
+class JobCounter {
+public:
+    bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+    
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> m_Pending{0};
+};
+
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+    
+    JobSystem() = default;
+    ~JobSystem();
+    
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    
+    bool Initialize(uint32_t workerCount = 0);
+    void Shutdown();
+    
+    void Schedule(Job job, JobCounter* counter = nullptr);
+    void Wait(JobCounter& counter);
+    
+    void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& func);
+    
+    uint32_t GetWorkerCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+    uint32_t GetThreadCount() const { return GetWorkerCount() + 1; }
+    
+private:
+    struct QueuedJob {
+        Job job;
+        JobCounter* counter = nullptr;
+    };
+    
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<QueuedJob> jobs;
+    };
+    
+    void WorkerLoop(uint32_t workerIndex);
+    bool TryRunJob(uint32_t queueIndex);
+    bool PopLocal(uint32_t queueIndex, QueuedJob& out);
+    bool Steal(uint32_t thiefIndex, QueuedJob& out);
+    uint32_t GetCurrentQueueIndex() const;
+    
+    std::vector<std::thread> m_Workers;
+    std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+    
+    std::mutex m_SleepMutex;
+    std::condition_variable m_SleepCondition;
+    std::atomic<uint32_t> m_QueuedJobs{0};
+    std::atomic<bool> m_Running{false};
+};
+
+}
@@ -1,91 +1,368 @@
 #include "Memory.hpp"
+#include <algorithm>
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
 #include <stdexcept>
 
 namespace Orchard::Memory {
 
-MemoryArena::MemoryArena(size_t size) : m_Size(size) {
-    m_Memory = static_cast<uint8_t*>(std::aligned_alloc(64, size));
-    if (!m_Memory) {
-        throw std::bad_alloc();
-    }
-    std::memset(m_Memory, 0, size);
+MemoryArena::MemoryArena(size_t blockSize)
+    : m_BlockSize(AlignForwardSize(blockSize, 64))
+{
+    m_Blocks.push_back(AllocateBlock(m_BlockSize));
 }
 
 MemoryArena::~MemoryArena() {
-    if (m_Memory) {
-        std::free(m_Memory);
+    for (Block& block : m_Blocks) {
+        std::free(block.memory);
     }
 }
 
+MemoryArena::Block MemoryArena::AllocateBlock(size_t size) {
+    uint8_t* memory = static_cast<uint8_t*>(std::aligned_alloc(64, size));
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    std::memset(memory, 0, size);
+    
+    m_Capacity += size;
+    return Block{ memory, size, 0 };
+}
+
 void* MemoryArena::Allocate(size_t size, size_t alignment) {
-    void* current = m_Memory + m_Used;
+    Block& block = m_Blocks[m_Current];
+    void* current = block.memory + block.used;
     void* aligned = AlignForward(current, alignment);
     
     size_t alignmentOffset = static_cast<uint8_t*>(aligned) - static_cast<uint8_t*>(current);
     size_t totalSize = alignmentOffset + size;
     
-    if (m_Used + totalSize > m_Size) {
-        return nullptr;
+    if (block.used + totalSize > block.size) {
+        return AllocateOverflow(size, alignment);
     }
     
-    m_Used += totalSize;
+    block.used += totalSize;
+    m_PeakUsed = std::max(m_PeakUsed, GetUsed());
     return aligned;
 }
 
+void* MemoryArena::AllocateOverflow(size_t size, size_t alignment) {
+    // Blocks are 64-byte aligned, so larger alignments may need padding at the front.
+    size_t required = size + (alignment > 64 ? alignment : 0);
+    
+    m_UsedBefore += m_Blocks[m_Current].used;
+    
+    size_t next = m_Current + 1;
+    while (next < m_Blocks.size() && m_Blocks[next].size < required) {
+        m_Blocks[next].used = 0;
+        ++next;
+    }
+    
+    if (next == m_Blocks.size()) {
+        m_Blocks.push_back(AllocateBlock(std::max(m_BlockSize, AlignForwardSize(required, 64))));
+    }
+    
+    m_Current = next;
+    m_Blocks[m_Current].used = 0;
+    return Allocate(size, alignment);
+}
+
 void MemoryArena::Clear() {
-    std::memset(m_Memory, 0, m_Size);
-    m_Used = 0;
+    for (Block& block : m_Blocks) {
+        std::memset(block.memory, 0, block.size);
+    }
+    Reset();
 }
 
 void MemoryArena::Reset() {
-    m_Used = 0;
+    m_Current = 0;
+    m_UsedBefore = 0;
+    m_Blocks[0].used = 0;
+}
+
+void MemoryArena::RewindTo(const Marker& marker) {
+    assert(marker.block <= m_Current && marker.used <= GetUsed() && "Marker does not belong to this arena state");
+    
+    m_Current = marker.block;
+    m_Blocks[m_Current].used = marker.offset;
+    m_UsedBefore = marker.used - marker.offset;
+}
+
+void MemoryArena::ReleaseSurplus(size_t retainCapacity) {
+    while (m_Blocks.size() > m_Current + 1 && m_Capacity - m_Blocks.back().size >= retainCapacity) {
+        m_Capacity -= m_Blocks.back().size;
+        std::free(m_Blocks.back().memory);
+        m_Blocks.pop_back();
+    }
+}
+
+namespace {
+
+struct ThreadFrameArenas {
+    explicit ThreadFrameArenas(size_t blockSize)
+        : arenas{ MemoryArena(blockSize), MemoryArena(blockSize) }
+    {}
+    
+    MemoryArena arenas[2];
+    uint64_t frames[2] = { ~uint64_t(0), ~uint64_t(0) };
+};
+
+}
+
+MemoryArena& FrameAllocator::GetThreadArena() {
+    thread_local ThreadFrameArenas local(s_BlockSize.load(std::memory_order_relaxed));
+    
+    uint64_t frame = GetFrameIndex();
+    size_t index = frame & 1;
+    MemoryArena& arena = local.arenas[index];
+    if (local.frames[index] != frame) {
+        arena.Reset();
+        arena.ReleaseSurplus(arena.GetPeakUsed());
+        arena.ResetPeak();
+        local.frames[index] = frame;
+    }
+    return arena;
+}
+
+namespace {
+
+std::mutex s_PoolMutex;
+std::vector<PoolAllocator*> s_Pools;
+std::vector<uint32_t> s_FreeThreadSlots;
+uint32_t s_NextThreadSlot = 0;
+
+}
+
+// Returns the exiting thread's magazines to their pools so the slot can be reused.
+struct PoolAllocator::ThreadSlot {
+    ThreadSlot() {
+        std::lock_guard<std::mutex> lock(s_PoolMutex);
+        if (!s_FreeThreadSlots.empty()) {
+            index = s_FreeThreadSlots.back();
+            s_FreeThreadSlots.pop_back();
+        } else {
+            index = s_NextThreadSlot++;
+        }
+    }
+    
+    ~ThreadSlot() {
+        std::lock_guard<std::mutex> lock(s_PoolMutex);
+        if (index < MAX_THREAD_SLOTS) {
+            for (PoolAllocator* pool : s_Pools) {
+                pool->FlushMagazine(index);
+            }
+        }
+        s_FreeThreadSlots.push_back(index);
+    }
+    
+    uint32_t index;
+};
+
+uint32_t PoolAllocator::GetThreadSlot() {
+    thread_local ThreadSlot slot;
+    return slot.index;
 }
 
 PoolAllocator::PoolAllocator(size_t elementSize, size_t elementCount)
-    : m_ElementSize(AlignForwardSize(elementSize, 16))
+    : m_ElementSize(AlignForwardSize(std::max(elementSize, sizeof(void*)), 16))
     , m_ElementCount(elementCount)
+    , m_Magazines(new Magazine[MAX_THREAD_SLOTS])
 {
-    size_t totalSize = m_ElementSize * m_ElementCount;
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free,
+                  "PoolAllocator requires lock-free 32 and 64-bit atomics");
+    assert(elementCount < NULL_INDEX && "PoolAllocator indices are 32-bit");
+    
+    size_t totalSize = AlignForwardSize(m_ElementSize * m_ElementCount, 64);
     m_Memory = static_cast<uint8_t*>(std::aligned_alloc(64, totalSize));
     if (!m_Memory) {
         throw std::bad_alloc();
     }
     
-    m_FreeList = nullptr;
     for (size_t i = 0; i < m_ElementCount; ++i) {
-        FreeNode* node = reinterpret_cast<FreeNode*>(m_Memory + i * m_ElementSize);
-        node->next = m_FreeList;
-        m_FreeList = node;
+        uint32_t next = i + 1 < m_ElementCount ? static_cast<uint32_t>(i + 1) : NULL_INDEX;
+        new (&NextOf(static_cast<uint32_t>(i))) std::atomic<uint32_t>(next);
     }
+    m_Head.store(Pack(m_ElementCount > 0 ? 0 : NULL_INDEX, 0), std::memory_order_relaxed);
+    m_FreeCount.store(m_ElementCount, std::memory_order_relaxed);
+    
+    std::lock_guard<std::mutex> lock(s_PoolMutex);
+    s_Pools.push_back(this);
 }
 
 PoolAllocator::~PoolAllocator() {
+    {
+        std::lock_guard<std::mutex> lock(s_PoolMutex);
+        s_Pools.erase(std::find(s_Pools.begin(), s_Pools.end(), this));
+    }
+    
     if (m_Memory) {
         std::free(m_Memory);
     }
 }
 
+uint32_t PoolAllocator::PopBatch(uint32_t* indices, uint32_t maxCount) {
+    uint64_t head = m_Head.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t count = 0;
+        uint32_t cursor = IndexOf(head);
+        while (count < maxCount && cursor < m_ElementCount) {
+            indices[count++] = cursor;
+            cursor = NextOf(cursor).load(std::memory_order_relaxed);
+        }
+        if (count == 0 && cursor == NULL_INDEX) return 0;
+        
+        // The walk may have raced with another thread; the tagged CAS only succeeds if the
+        // head is untouched, in which case every link we followed was still on the stack.
+        if (cursor != NULL_INDEX && cursor >= m_ElementCount) {
+            head = m_Head.load(std::memory_order_acquire);
+            continue;
+        }
+        
+        if (m_Head.compare_exchange_weak(head, Pack(cursor, TagOf(head) + 1),
+                                         std::memory_order_acquire, std::memory_order_acquire)) {
+            m_FreeCount.fetch_sub(count, std::memory_order_relaxed);
+            return count;
+        }
+    }
+}
+
+void PoolAllocator::PushBatch(const uint32_t* indices, uint32_t count) {
+    for (uint32_t i = 0; i + 1 < count; ++i) {
+        NextOf(indices[i]).store(indices[i + 1], std::memory_order_relaxed);
+    }
+    
+    std::atomic<uint32_t>& last = NextOf(indices[count - 1]);
+    uint64_t head = m_Head.load(std::memory_order_relaxed);
+    do {
+        last.store(IndexOf(head), std::memory_order_relaxed);
+    } while (!m_Head.compare_exchange_weak(head, Pack(indices[0], TagOf(head) + 1),
+                                           std::memory_order_release, std::memory_order_relaxed));
+    
+    m_FreeCount.fetch_add(count, std::memory_order_relaxed);
+}
+
+bool PoolAllocator::TakeOne(Magazine& magazine, uint32_t& index) {
+    uint64_t state = magazine.state.load(std::memory_order_acquire);
+    while (IndexOf(state) > 0) {
+        uint32_t count = IndexOf(state);
+        index = magazine.items[count - 1].load(std::memory_order_relaxed);
+        if (magazine.state.compare_exchange_weak(state, Pack(count - 1, TagOf(state) + 1),
+                                                 std::memory_order_acquire, std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void PoolAllocator::PutBatch(Magazine& magazine, const uint32_t* indices, uint32_t count) {
+    // Only the owning thread adds to a magazine; other threads can only take from it, so a
+    // failed exchange means the count shrank and the batch is rewritten further down.
+    uint64_t state = magazine.state.load(std::memory_order_relaxed);
+    while (true) {
+        uint32_t first = IndexOf(state);
+        assert(first + count <= MAGAZINE_CAPACITY && "Magazine overflow");
+        for (uint32_t i = 0; i < count; ++i) {
+            magazine.items[first + i].store(indices[i], std::memory_order_relaxed);
+        }
+        if (magazine.state.compare_exchange_weak(state, Pack(first + count, TagOf(state) + 1),
+                                                 std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+uint32_t PoolAllocator::Drain(Magazine& magazine, uint32_t keep, uint32_t* indices) {
+    uint64_t state = magazine.state.load(std::memory_order_acquire);
+    while (IndexOf(state) > keep) {
+        uint32_t count = IndexOf(state);
+        for (uint32_t i = keep; i < count; ++i) {
+            indices[i - keep] = magazine.items[i].load(std::memory_order_relaxed);
+        }
+        if (magazine.state.compare_exchange_weak(state, Pack(keep, TagOf(state) + 1),
+                                                 std::memory_order_acquire, std::memory_order_acquire)) {
+            return count - keep;
+        }
+    }
+    return 0;
+}
+
+bool PoolAllocator::Steal(uint32_t slot, uint32_t& index) {
+    for (uint32_t other = 0; other < MAX_THREAD_SLOTS; ++other) {
+        if (other != slot && TakeOne(m_Magazines[other], index)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void* PoolAllocator::Allocate() {
-    if (!m_FreeList) {
-        return nullptr;
+    uint32_t slot = GetThreadSlot();
+    uint32_t index;
+    if (slot >= MAX_THREAD_SLOTS) {
+        if (!PopBatch(&index, 1) && !Steal(slot, index)) {
+            return nullptr;
+        }
+        return m_Memory + index * m_ElementSize;
     }
     
-    FreeNode* node = m_FreeList;
-    m_FreeList = m_FreeList->next;
-    m_UsedCount++;
+    Magazine& magazine = m_Magazines[slot];
+    if (!TakeOne(magazine, index)) {
+        uint32_t batch[MAGAZINE_CAPACITY / 2];
+        uint32_t count = PopBatch(batch, MAGAZINE_CAPACITY / 2);
+        if (count > 0) {
+            index = batch[--count];
+            if (count > 0) {
+                PutBatch(magazine, batch, count);
+            }
+        } else if (!Steal(slot, index)) {
+            return nullptr;
+        }
+    }
     
-    return node;
+    return m_Memory + index * m_ElementSize;
 }
 
 void PoolAllocator::Deallocate(void* ptr) {
     if (!ptr) return;
     
-    FreeNode* node = static_cast<FreeNode*>(ptr);
-    node->next = m_FreeList;
-    m_FreeList = node;
-    m_UsedCount--;
+    size_t offset = static_cast<uint8_t*>(ptr) - m_Memory;
+    assert(offset % m_ElementSize == 0 && offset / m_ElementSize < m_ElementCount && "Pointer does not belong to this pool");
+    uint32_t index = static_cast<uint32_t>(offset / m_ElementSize);
+    
+    uint32_t slot = GetThreadSlot();
+    if (slot >= MAX_THREAD_SLOTS) {
+        PushBatch(&index, 1);
+        return;
+    }
+    
+    Magazine& magazine = m_Magazines[slot];
+    if (IndexOf(magazine.state.load(std::memory_order_relaxed)) == MAGAZINE_CAPACITY) {
+        uint32_t surplus[MAGAZINE_CAPACITY];
+        uint32_t count = Drain(magazine, MAGAZINE_CAPACITY / 2, surplus);
+        if (count > 0) {
+            PushBatch(surplus, count);
+        }
+    }
+    
+    PutBatch(magazine, &index, 1);
+}
+
+void PoolAllocator::FlushMagazine(uint32_t slot) {
+    uint32_t items[MAGAZINE_CAPACITY];
+    uint32_t count = Drain(m_Magazines[slot], 0, items);
+    if (count > 0) {
+        PushBatch(items, count);
+    }
+}
+
+size_t PoolAllocator::GetUsedCount() const {
+    size_t free = m_FreeCount.load(std::memory_order_relaxed);
+    for (uint32_t slot = 0; slot < MAX_THREAD_SLOTS; ++slot) {
+        free += IndexOf(m_Magazines[slot].state.load(std::memory_order_relaxed));
+    }
+    return free < m_ElementCount ? m_ElementCount - free : 0;
 }
 
 }
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <new>
+#include <vector>
 
 namespace Orchard::Memory {
 
@@ -13,21 +15,88 @@ constexpr size_t GB = 1024 * MB;
 
 class MemoryArena {
 public:
-    explicit MemoryArena(size_t size);
+    struct Marker {
+        size_t block = 0;
+        size_t offset = 0;
+        size_t used = 0;
+    };
+    
+    explicit MemoryArena(size_t blockSize);
     ~MemoryArena();
     
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator=(const MemoryArena&) = delete;
+    
     void* Allocate(size_t size, size_t alignment = 16);
     void Clear();
     void Reset();
     
-    size_t GetSize() const { return m_Size; }
-    size_t GetUsed() const { return m_Used; }
-    size_t GetAvailable() const { return m_Size - m_Used; }
+    Marker GetMarker() const { return Marker{ m_Current, m_Blocks[m_Current].used, GetUsed() }; }
+    void RewindTo(const Marker& marker);
+    
+    void ReleaseSurplus(size_t retainCapacity = 0);
+    
+    size_t GetSize() const { return m_Capacity; }
+    size_t GetUsed() const { return m_UsedBefore + m_Blocks[m_Current].used; }
+    size_t GetAvailable() const { return m_Blocks[m_Current].size - m_Blocks[m_Current].used; }
+    size_t GetPeakUsed() const { return m_PeakUsed; }
+    size_t GetBlockSize() const { return m_BlockSize; }
+    size_t GetBlockCount() const { return m_Blocks.size(); }
+    
+    void ResetPeak() { m_PeakUsed = GetUsed(); }
+    
+private:
+    struct Block {
+        uint8_t* memory;
+        size_t size;
+        size_t used;
+    };
+    
+    Block AllocateBlock(size_t size);
+    void* AllocateOverflow(size_t size, size_t alignment);
+    
+    std::vector<Block> m_Blocks;
+    size_t m_Current = 0;
+    size_t m_UsedBefore = 0;
+    size_t m_BlockSize = 0;
+    size_t m_Capacity = 0;
+    size_t m_PeakUsed = 0;
+};
+
+class ArenaScope {
+public:
+    explicit ArenaScope(MemoryArena& arena) : m_Arena(arena), m_Marker(arena.GetMarker()) {}
+    ~ArenaScope() { m_Arena.RewindTo(m_Marker); }
+    
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+    
+private:
+    MemoryArena& m_Arena;
+    MemoryArena::Marker m_Marker;
+};
+
+class FrameAllocator {
+public:
+    static void* Allocate(size_t size, size_t alignment = 16) {
+        return GetThreadArena().Allocate(size, alignment);
+    }
+    
+    template<typename T>
+    static T* AllocateArray(size_t count) {
+        return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+    }
+    
+    static MemoryArena& GetThreadArena();
+    
+    static void BeginFrame() { s_FrameIndex.fetch_add(1, std::memory_order_acq_rel); }
+    static uint64_t GetFrameIndex() { return s_FrameIndex.load(std::memory_order_acquire); }
+    
+    static void SetBlockSize(size_t blockSize) { s_BlockSize.store(blockSize, std::memory_order_relaxed); }
     
 private:
-    uint8_t* m_Memory = nullptr;
-    size_t m_Size = 0;
-    size_t m_Used = 0;
+    static inline std::atomic<uint64_t> s_FrameIndex{0};
+    static inline std::atomic<size_t> s_BlockSize{256 * KB};
 };
 
 class PoolAllocator {
@@ -35,23 +104,54 @@ public:
     PoolAllocator(size_t elementSize, size_t elementCount);
     ~PoolAllocator();
     
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+    
     void* Allocate();
     void Deallocate(void* ptr);
     
     size_t GetElementSize() const { return m_ElementSize; }
     size_t GetCapacity() const { return m_ElementCount; }
-    size_t GetUsedCount() const { return m_UsedCount; }
+    size_t GetUsedCount() const;
     
 private:
-    struct FreeNode {
-        FreeNode* next;
+    static constexpr uint32_t NULL_INDEX = ~uint32_t(0);
+    static constexpr uint32_t MAGAZINE_CAPACITY = 32;
+    static constexpr uint32_t MAX_THREAD_SLOTS = 64;
+    
+    struct alignas(64) Magazine {
+        std::atomic<uint32_t> items[MAGAZINE_CAPACITY];
+        std::atomic<uint64_t> state{0};
     };
     
-    uint8_t* m_Memory = nullptr;
-    FreeNode* m_FreeList = nullptr;
+    struct ThreadSlot;
+    
+    static uint32_t GetThreadSlot();
+    void FlushMagazine(uint32_t slot);
+    
+    static bool TakeOne(Magazine& magazine, uint32_t& index);
+    static void PutBatch(Magazine& magazine, const uint32_t* indices, uint32_t count);
+    static uint32_t Drain(Magazine& magazine, uint32_t keep, uint32_t* indices);
+    bool Steal(uint32_t slot, uint32_t& index);
+    
+    static uint64_t Pack(uint32_t index, uint32_t tag) { return (static_cast<uint64_t>(tag) << 32) | index; }
+    static uint32_t IndexOf(uint64_t head) { return static_cast<uint32_t>(head); }
+    static uint32_t TagOf(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+    
+    std::atomic<uint32_t>& NextOf(uint32_t index) {
+        return *reinterpret_cast<std::atomic<uint32_t>*>(m_Memory + index * m_ElementSize);
+    }
+    
+    uint32_t PopBatch(uint32_t* indices, uint32_t maxCount);
+    void PushBatch(const uint32_t* indices, uint32_t count);
+    
+    alignas(64) std::atomic<uint64_t> m_Head{0};
+    std::atomic<size_t> m_FreeCount{0};
+    
+    alignas(64) uint8_t* m_Memory = nullptr;
     size_t m_ElementSize = 0;
     size_t m_ElementCount = 0;
-    size_t m_UsedCount = 0;
+    std::unique_ptr<Magazine[]> m_Magazines;
 };
 
 template<typename T>
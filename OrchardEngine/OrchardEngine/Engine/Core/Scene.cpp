@@ -1,10 +1,14 @@
 #include "Scene.hpp"
+#include "Engine.hpp"
 #include "../Rendering/Renderer.hpp"
+#include "../ECS/Systems/TransformHierarchySystem.hpp"
 
 namespace Orchard {
 
 Scene::Scene(const std::string& name) : m_Name(name) {
     m_World = std::make_unique<ECS::World>();
+    m_World->SetJobSystem(Engine::Instance().GetJobSystem());
+    m_World->AddSystem(std::make_unique<ECS::TransformHierarchySystem>());
 }
 
 Scene::~Scene() {
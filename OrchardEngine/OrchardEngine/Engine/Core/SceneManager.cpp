@@ -1,5 +1,7 @@
 #include "SceneManager.hpp"
 #include "Scene.hpp"
+#include "../ECS/WorldSerializer.hpp"
+#include <filesystem>
 #include <iostream>
 
 namespace Orchard {
@@ -40,12 +42,26 @@ std::shared_ptr<Scene> SceneManager::CreateScene(const std::string& name) {
 
 bool SceneManager::LoadScene(const std::string& path) {
     std::cout << "Loading scene from: " << path << std::endl;
-    return false;
+    
+    auto scene = std::make_shared<Scene>(std::filesystem::path(path).stem().string());
+    if (!ECS::WorldSerializer::Load(*scene->GetWorld(), path)) {
+        return false;
+    }
+    
+    m_Scenes.push_back(scene);
+    m_ActiveScene = scene;
+    return true;
 }
 
 bool SceneManager::SaveScene(const std::string& path) {
     std::cout << "Saving scene to: " << path << std::endl;
-    return false;
+    
+    if (!m_ActiveScene) {
+        std::cerr << "SceneManager: no active scene to save" << std::endl;
+        return false;
+    }
+    
+    return ECS::WorldSerializer::Save(*m_ActiveScene->GetWorld(), path);
 }
 
 void SceneManager::SetActiveScene(std::shared_ptr<Scene> scene) {
@@ -1,92 +1,459 @@
 #include "Archetype.hpp"
 #include <algorithm>
+#include <cassert>
 
 namespace Orchard::ECS {
 
-Archetype::Archetype(const std::vector<ComponentInfo>& components)
+Archetype::Archetype(const std::vector<ComponentInfo>& components, ChunkPool& chunkPool,
+                     const std::atomic<uint32_t>& changeVersion)
     : m_ComponentTypes(components)
+    , m_ChunkPool(chunkPool)
+    , m_ChangeVersion(changeVersion)
 {
     std::sort(m_ComponentTypes.begin(), m_ComponentTypes.end(),
         [](const ComponentInfo& a, const ComponentInfo& b) {
-            return a.alignment > b.alignment;
+            return a.stableID < b.stableID;
         });
     
-    size_t offset = 0;
+    assert(m_ComponentTypes.size() < NO_COLUMN && "Too many components in one archetype");
+    
+    m_ColumnLookup.fill(NO_COLUMN);
+    m_SharedValues.resize(m_ComponentTypes.size());
     for (size_t i = 0; i < m_ComponentTypes.size(); ++i) {
-        offset = (offset + m_ComponentTypes[i].alignment - 1) & ~(m_ComponentTypes[i].alignment - 1);
-        m_ComponentTypes[i].offsetInChunk = offset;
-        m_ComponentIndexMap[m_ComponentTypes[i].typeID] = i;
-        offset += m_ComponentTypes[i].size;
+        m_ColumnLookup[m_ComponentTypes[i].typeID] = static_cast<uint8_t>(i);
+        m_Signature.set(m_ComponentTypes[i].typeID);
+        m_HasSharedComponents |= m_ComponentTypes[i].sharedIndex != INVALID_SHARED_INDEX;
     }
     
     m_EntitiesPerChunk = CalculateEntitiesPerChunk();
+    CalculateChunkLayout(m_EntitiesPerChunk);
+}
+
+Archetype::~Archetype() {
+    for (auto& chunk : m_Chunks) {
+        for (size_t i = 0; i < chunk->entityCount; ++i) {
+            DestroyComponents(*chunk, i);
+        }
+        m_ChunkPool.Deallocate(chunk->data);
+    }
+}
+
+size_t Archetype::CalculateChunkLayout(size_t entitiesPerChunk) {
+    size_t offset = sizeof(Entity) * entitiesPerChunk;
+    
+    for (auto& info : m_ComponentTypes) {
+        if (info.size == 0) continue;
+        
+        size_t alignment = std::max(info.alignment, CHUNK_COLUMN_ALIGNMENT);
+        offset = (offset + alignment - 1) & ~(alignment - 1);
+        info.offsetInChunk = offset;
+        offset += info.size * entitiesPerChunk;
+    }
+    
+    return offset;
 }
 
 size_t Archetype::CalculateEntitiesPerChunk() {
-    size_t totalComponentSize = 0;
+    size_t bytesPerEntity = sizeof(Entity);
     for (const auto& info : m_ComponentTypes) {
-        totalComponentSize += info.size;
+        bytesPerEntity += info.size;
     }
     
-    if (totalComponentSize == 0) return 0;
+    size_t count = CHUNK_SIZE / bytesPerEntity;
+    while (count > 0 && CalculateChunkLayout(count) > CHUNK_SIZE) {
+        --count;
+    }
     
-    return CHUNK_SIZE / totalComponentSize;
+    assert(count > 0 && "Archetype components do not fit in a single chunk");
+    assert(count <= ROW_MASK + 1);
+    return count;
 }
 
-void Archetype::AllocateNewChunk() {
-    m_Chunks.push_back(std::make_unique<Chunk>(m_EntitiesPerChunk));
+size_t Archetype::AcquireInsertChunk() {
+    if (m_InsertChunk < m_Chunks.size() && m_Chunks[m_InsertChunk]->entityCount < m_Chunks[m_InsertChunk]->capacity) {
+        return m_InsertChunk;
+    }
+    
+    if (!m_ReleasedChunks.empty()) {
+        m_InsertChunk = m_ReleasedChunks.back();
+        m_ReleasedChunks.pop_back();
+        
+        Chunk& chunk = *m_Chunks[m_InsertChunk];
+        chunk.data = m_ChunkPool.Allocate();
+        std::fill(chunk.columnVersions.begin(), chunk.columnVersions.end(), GetChangeVersion());
+        return m_InsertChunk;
+    }
+    
+    m_Chunks.push_back(std::make_unique<Chunk>(m_ChunkPool.Allocate(), m_EntitiesPerChunk,
+                                               m_ComponentTypes.size(), GetChangeVersion()));
+    m_InsertChunk = m_Chunks.size() - 1;
+    return m_InsertChunk;
 }
 
-size_t Archetype::AddEntity(Entity entity) {
-    if (m_Chunks.empty() || m_Chunks.back()->entityCount >= m_Chunks.back()->capacity) {
-        AllocateNewChunk();
+void Archetype::ReleaseChunk(size_t chunkIndex) {
+    Chunk& chunk = *m_Chunks[chunkIndex];
+    m_ChunkPool.Deallocate(chunk.data);
+    chunk.data = nullptr;
+    
+    if (m_InsertChunk == chunkIndex) {
+        m_InsertChunk = ~size_t(0);
+    }
+    
+    if (chunkIndex + 1 < m_Chunks.size()) {
+        m_ReleasedChunks.push_back(chunkIndex);
+        return;
     }
     
-    auto& chunk = m_Chunks.back();
+    m_Chunks.pop_back();
+    TrimReleasedChunks();
+}
+
+void Archetype::TrimReleasedChunks() {
+    while (!m_Chunks.empty() && !m_Chunks.back()->data) {
+        size_t last = m_Chunks.size() - 1;
+        m_ReleasedChunks.erase(std::remove(m_ReleasedChunks.begin(), m_ReleasedChunks.end(), last), m_ReleasedChunks.end());
+        m_Chunks.pop_back();
+    }
+}
+
+size_t Archetype::AppendChunk(size_t entityCount) {
+    assert(entityCount <= m_EntitiesPerChunk);
+    
+    m_Chunks.push_back(std::make_unique<Chunk>(m_ChunkPool.Allocate(), m_EntitiesPerChunk,
+                                               m_ComponentTypes.size(), GetChangeVersion()));
+    m_Chunks.back()->entityCount = entityCount;
+    m_InsertChunk = m_Chunks.size() - 1;
+    return m_InsertChunk;
+}
+
+void Archetype::MarkChunkChanged(Chunk& chunk) {
+    std::fill(chunk.columnVersions.begin(), chunk.columnVersions.end(), GetChangeVersion());
+}
+
+size_t Archetype::AddEntity(Entity entity) {
+    size_t chunkIndex = AcquireInsertChunk();
+    
+    auto& chunk = m_Chunks[chunkIndex];
     size_t index = chunk->entityCount++;
+    chunk->GetEntities()[index] = entity;
+    MarkChunkChanged(*chunk);
     
-    return (m_Chunks.size() - 1) * m_EntitiesPerChunk + index;
+    return MakeIndex(chunkIndex, index);
+}
+
+void Archetype::AddEntities(const Entity* entities, size_t count, const void* const* columnValues, size_t* outIndices,
+                            size_t valueCount) {
+    size_t written = 0;
+    while (written < count) {
+        size_t chunkIndex = AcquireInsertChunk();
+        
+        Chunk& chunk = *m_Chunks[chunkIndex];
+        size_t first = chunk.entityCount;
+        size_t batch = std::min(count - written, chunk.capacity - first);
+        
+        std::memcpy(chunk.GetEntities() + first, entities + written, batch * sizeof(Entity));
+        for (size_t i = 0; i < m_ComponentTypes.size(); ++i) {
+            FillColumn(chunk, i, first, batch, columnValues[i], valueCount, written % valueCount);
+        }
+        
+        for (size_t i = 0; i < batch; ++i) {
+            outIndices[written + i] = MakeIndex(chunkIndex, first + i);
+        }
+        
+        chunk.entityCount += batch;
+        MarkChunkChanged(chunk);
+        written += batch;
+    }
 }
 
-void Archetype::RemoveEntity(size_t index) {
-    size_t chunkIndex = index / m_EntitiesPerChunk;
-    size_t entityIndex = index % m_EntitiesPerChunk;
+void Archetype::FillColumn(Chunk& chunk, size_t componentIndex, size_t first, size_t count,
+                           const void* values, size_t valueCount, size_t phase) {
+    const ComponentInfo& info = m_ComponentTypes[componentIndex];
+    const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(info.typeID);
+    uint8_t* dst = chunk.data + info.offsetInChunk + first * info.size;
+    const uint8_t* src = static_cast<const uint8_t*>(values);
     
-    if (chunkIndex >= m_Chunks.size()) return;
+    if (!typeInfo.trivial && !values) {
+        assert(typeInfo.defaultConstruct && "Non-trivial components without an initial value must be default constructible");
+        for (size_t i = 0; i < count; ++i) {
+            typeInfo.defaultConstruct(dst + i * info.size);
+        }
+        return;
+    }
+    
+    if (!typeInfo.trivial) {
+        assert(typeInfo.copyConstruct && "Non-trivial components require a copyable initial value");
+        for (size_t i = 0; i < count; ++i) {
+            typeInfo.copyConstruct(dst + i * info.size, src + ((phase + i) % valueCount) * info.size);
+        }
+        return;
+    }
+    
+    if (!values) {
+        std::memset(dst, 0, count * info.size);
+        return;
+    }
+    
+    size_t period = std::min(valueCount, count);
+    size_t head = std::min(period, valueCount - phase);
+    std::memcpy(dst, src + phase * info.size, head * info.size);
+    std::memcpy(dst + head * info.size, src, (period - head) * info.size);
+    for (size_t filled = period; filled < count;) {
+        size_t copy = std::min(filled, count - filled);
+        std::memcpy(dst + filled * info.size, dst, copy * info.size);
+        filled += copy;
+    }
+}
+
+void Archetype::DestroyComponents(Chunk& chunk, size_t indexInChunk) {
+    for (const auto& info : m_ComponentTypes) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(info.typeID);
+        if (!typeInfo.trivial) {
+            typeInfo.destroy(chunk.data + info.offsetInChunk + indexInChunk * info.size);
+        }
+    }
+}
+
+Entity Archetype::RemoveEntity(size_t index) {
+    size_t chunkIndex = GetChunkIndex(index);
+    size_t entityIndex = GetRow(index);
+    
+    if (chunkIndex >= m_Chunks.size()) return Entity();
     
     auto& chunk = m_Chunks[chunkIndex];
-    if (entityIndex >= chunk->entityCount) return;
+    if (entityIndex >= chunk->entityCount) return Entity();
+    
+    DestroyComponents(*chunk, entityIndex);
     
+    Entity movedEntity;
     size_t lastEntityIndex = chunk->entityCount - 1;
     if (entityIndex != lastEntityIndex) {
-        for (const auto& info : m_ComponentTypes) {
-            uint8_t* src = chunk->data + info.offsetInChunk + lastEntityIndex * info.size;
-            uint8_t* dst = chunk->data + info.offsetInChunk + entityIndex * info.size;
+        MoveRow(*chunk, lastEntityIndex, *chunk, entityIndex);
+        movedEntity = chunk->GetEntities()[entityIndex];
+        MarkChunkChanged(*chunk);
+    }
+    
+    chunk->entityCount--;
+    if (chunk->entityCount == 0) {
+        ReleaseChunk(chunkIndex);
+    }
+    return movedEntity;
+}
+
+void Archetype::MoveEntityTo(size_t index, const ArchetypeEdge& edge, size_t destinationIndex) {
+    Archetype& destination = *edge.archetype;
+    Chunk& srcChunk = *m_Chunks[GetChunkIndex(index)];
+    Chunk& dstChunk = *destination.m_Chunks[GetChunkIndex(destinationIndex)];
+    size_t srcRow = GetRow(index);
+    size_t dstRow = GetRow(destinationIndex);
+    
+    for (const auto& [srcColumn, dstColumn] : edge.sharedColumns) {
+        const ComponentInfo& info = m_ComponentTypes[srcColumn];
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(info.typeID);
+        uint8_t* src = srcChunk.data + info.offsetInChunk + srcRow * info.size;
+        uint8_t* dst = dstChunk.data + destination.m_ComponentTypes[dstColumn].offsetInChunk + dstRow * info.size;
+        if (typeInfo.trivial) {
             std::memcpy(dst, src, info.size);
+        } else {
+            typeInfo.moveConstruct(dst, src);
+        }
+    }
+}
+
+void Archetype::MoveRow(Chunk& src, size_t srcRow, Chunk& dst, size_t dstRow) {
+    for (const auto& info : m_ComponentTypes) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(info.typeID);
+        uint8_t* from = src.data + info.offsetInChunk + srcRow * info.size;
+        uint8_t* to = dst.data + info.offsetInChunk + dstRow * info.size;
+        if (typeInfo.trivial) {
+            std::memcpy(to, from, info.size);
+        } else {
+            typeInfo.moveConstruct(to, from);
+            typeInfo.destroy(from);
         }
     }
     
-    chunk->entityCount--;
+    dst.GetEntities()[dstRow] = src.GetEntities()[srcRow];
+}
+
+bool Archetype::NeedsCompaction() const {
+    if (!m_ReleasedChunks.empty()) return true;
+    
+    size_t requiredChunks = (GetEntityCount() + m_EntitiesPerChunk - 1) / m_EntitiesPerChunk;
+    return requiredChunks < m_Chunks.size();
+}
+
+size_t Archetype::Compact(size_t maxMoves, const std::function<void(Entity, size_t)>& onMoved) {
+    size_t moved = 0;
+    size_t holeIndex = 0;
+    
+    while (moved < maxMoves && m_Chunks.size() > 1) {
+        size_t tailIndex = m_Chunks.size() - 1;
+        
+        if (!m_ReleasedChunks.empty()) {
+            size_t slot = *std::min_element(m_ReleasedChunks.begin(), m_ReleasedChunks.end());
+            m_ReleasedChunks.erase(std::find(m_ReleasedChunks.begin(), m_ReleasedChunks.end(), slot));
+            std::swap(m_Chunks[slot], m_Chunks[tailIndex]);
+            if (m_InsertChunk == tailIndex) {
+                m_InsertChunk = slot;
+            }
+            
+            Chunk& chunk = *m_Chunks[slot];
+            MarkChunkChanged(chunk);
+            const Entity* entities = chunk.GetEntities();
+            for (size_t row = 0; row < chunk.entityCount; ++row) {
+                onMoved(entities[row], MakeIndex(slot, row));
+            }
+            moved += chunk.entityCount;
+            
+            m_ReleasedChunks.push_back(tailIndex);
+            TrimReleasedChunks();
+            continue;
+        }
+        
+        while (holeIndex < tailIndex && m_Chunks[holeIndex]->entityCount >= m_Chunks[holeIndex]->capacity) {
+            ++holeIndex;
+        }
+        if (holeIndex >= tailIndex) break;
+        
+        Chunk& hole = *m_Chunks[holeIndex];
+        Chunk& tail = *m_Chunks[tailIndex];
+        size_t count = std::min({ hole.capacity - hole.entityCount, tail.entityCount, maxMoves - moved });
+        
+        for (size_t i = 0; i < count; ++i) {
+            size_t srcRow = tail.entityCount - 1;
+            size_t dstRow = hole.entityCount;
+            MoveRow(tail, srcRow, hole, dstRow);
+            
+            hole.entityCount++;
+            tail.entityCount--;
+            onMoved(hole.GetEntities()[dstRow], MakeIndex(holeIndex, dstRow));
+        }
+        
+        moved += count;
+        MarkChunkChanged(hole);
+        if (tail.entityCount == 0) {
+            ReleaseChunk(tailIndex);
+        } else {
+            MarkChunkChanged(tail);
+        }
+    }
+    
+    return moved;
+}
+
+ArchetypeEdge Archetype::BuildEdge(const Archetype* source, Archetype* target) {
+    ArchetypeEdge edge;
+    edge.archetype = target;
+    edge.cached = true;
+    
+    if (!source || !target) return edge;
+    
+    const auto& srcTypes = source->m_ComponentTypes;
+    const auto& dstTypes = target->m_ComponentTypes;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < srcTypes.size() && j < dstTypes.size()) {
+        if (srcTypes[i].stableID < dstTypes[j].stableID) {
+            ++i;
+        } else if (dstTypes[j].stableID < srcTypes[i].stableID) {
+            ++j;
+        } else {
+            edge.sharedColumns.emplace_back(static_cast<uint32_t>(i), static_cast<uint32_t>(j));
+            ++i;
+            ++j;
+        }
+    }
+    
+    return edge;
+}
+
+const ArchetypeEdge& Archetype::SetEdge(std::vector<ArchetypeEdge>& edges, ComponentTypeID typeID,
+                                        const Archetype* source, Archetype* target) {
+    if (typeID >= edges.size()) {
+        edges.resize(typeID + 1);
+    }
+    edges[typeID] = BuildEdge(source, target);
+    return edges[typeID];
+}
+
+const ArchetypeEdge& Archetype::SetAddEdge(ComponentTypeID typeID, Archetype* target) {
+    return SetEdge(m_AddEdges, typeID, this, target);
+}
+
+const ArchetypeEdge& Archetype::SetRemoveEdge(ComponentTypeID typeID, Archetype* target) {
+    return SetEdge(m_RemoveEdges, typeID, this, target);
+}
+
+void Archetype::ForgetRetiredEdges() {
+    for (auto* edges : { &m_AddEdges, &m_RemoveEdges }) {
+        for (ArchetypeEdge& edge : *edges) {
+            if (edge.cached && edge.archetype && edge.archetype->IsRetired()) {
+                edge = ArchetypeEdge();
+            }
+        }
+    }
+}
+
+void Archetype::SetSharedValue(size_t componentIndex, std::shared_ptr<const void> value) {
+    m_ComponentTypes[componentIndex].sharedValue = value.get();
+    m_SharedValues[componentIndex] = std::move(value);
+    m_Retired = false;
+}
+
+void Archetype::ReleaseSharedValues() {
+    assert(GetEntityCount() == 0 && "Only empty archetypes can release their shared values");
+    for (size_t i = 0; i < m_ComponentTypes.size(); ++i) {
+        m_ComponentTypes[i].sharedValue = nullptr;
+        m_SharedValues[i].reset();
+    }
+    m_Retired = true;
 }
 
 void* Archetype::GetComponent(size_t entityIndex, ComponentTypeID typeID) {
-    auto it = m_ComponentIndexMap.find(typeID);
-    if (it == m_ComponentIndexMap.end()) return nullptr;
+    uint8_t column = m_ColumnLookup[typeID];
+    if (column == NO_COLUMN) return nullptr;
     
-    size_t chunkIndex = entityIndex / m_EntitiesPerChunk;
-    size_t indexInChunk = entityIndex % m_EntitiesPerChunk;
+    size_t chunkIndex = GetChunkIndex(entityIndex);
+    size_t indexInChunk = GetRow(entityIndex);
     
     if (chunkIndex >= m_Chunks.size()) return nullptr;
     
     auto& chunk = m_Chunks[chunkIndex];
     if (indexInChunk >= chunk->entityCount) return nullptr;
     
-    const auto& info = m_ComponentTypes[it->second];
+    MarkColumnChanged(*chunk, column);
+    
+    const auto& info = m_ComponentTypes[column];
+    if (info.sharedValue) return const_cast<void*>(info.sharedValue);
     return chunk->data + info.offsetInChunk + indexInChunk * info.size;
 }
 
 const void* Archetype::GetComponent(size_t entityIndex, ComponentTypeID typeID) const {
-    return const_cast<Archetype*>(this)->GetComponent(entityIndex, typeID);
+    uint8_t column = m_ColumnLookup[typeID];
+    if (column == NO_COLUMN) return nullptr;
+    
+    size_t chunkIndex = GetChunkIndex(entityIndex);
+    size_t indexInChunk = GetRow(entityIndex);
+    
+    if (chunkIndex >= m_Chunks.size()) return nullptr;
+    
+    const auto& chunk = m_Chunks[chunkIndex];
+    if (indexInChunk >= chunk->entityCount) return nullptr;
+    
+    const auto& info = m_ComponentTypes[column];
+    if (info.sharedValue) return info.sharedValue;
+    return chunk->data + info.offsetInChunk + indexInChunk * info.size;
+}
+
+Entity Archetype::GetEntity(size_t entityIndex) const {
+    size_t chunkIndex = GetChunkIndex(entityIndex);
+    size_t indexInChunk = GetRow(entityIndex);
+    
+    if (chunkIndex >= m_Chunks.size()) return Entity();
+    if (indexInChunk >= m_Chunks[chunkIndex]->entityCount) return Entity();
+    
+    return m_Chunks[chunkIndex]->GetEntities()[indexInChunk];
 }
 
 size_t Archetype::GetEntityCount() const {
@@ -101,13 +468,14 @@ void Archetype::IterateEntities(std::function<void(Entity, void**)> callback) {
     std::vector<void*> components(m_ComponentTypes.size());
     
     for (const auto& chunk : m_Chunks) {
+        const Entity* entities = chunk->GetEntities();
         for (size_t i = 0; i < chunk->entityCount; ++i) {
             for (size_t j = 0; j < m_ComponentTypes.size(); ++j) {
                 const auto& info = m_ComponentTypes[j];
                 components[j] = chunk->data + info.offsetInChunk + i * info.size;
             }
             
-            callback(Entity(), components.data());
+            callback(entities[i], components.data());
         }
     }
 }
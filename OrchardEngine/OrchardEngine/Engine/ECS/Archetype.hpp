@@ -1,57 +1,106 @@
 #pragma once
 
+#include "ChunkPool.hpp"
 #include "Component.hpp"
 #include "Entity.hpp"
+#include <array>
+#include <atomic>
 #include <vector>
-#include <unordered_map>
+#include <utility>
 #include <memory>
+#include <functional>
+#include <cstdlib>
 #include <cstring>
 
 namespace Orchard::ECS {
 
-constexpr size_t CHUNK_SIZE = 16384;
-
 struct ComponentInfo {
     ComponentTypeID typeID;
+    uint64_t stableID;
     size_t size;
     size_t alignment;
     size_t offsetInChunk;
+    uint32_t sharedIndex;
+    const void* sharedValue;
     
-    ComponentInfo(ComponentTypeID id, size_t s, size_t a)
-        : typeID(id), size(s), alignment(a), offsetInChunk(0) {}
+    ComponentInfo(ComponentTypeID id, size_t s, size_t a,
+                  uint32_t shared = INVALID_SHARED_INDEX, const void* value = nullptr)
+        : typeID(id), stableID(ComponentRegistry::GetTypeInfo(id).stableID), size(s), alignment(a)
+        , offsetInChunk(0), sharedIndex(shared), sharedValue(value) {}
+};
+
+class Archetype;
+
+struct ArchetypeEdge {
+    Archetype* archetype = nullptr;
+    std::vector<std::pair<uint32_t, uint32_t>> sharedColumns;
+    bool cached = false;
 };
 
 class Archetype {
 public:
+    static constexpr size_t INVALID_COLUMN = ~size_t(0);
+    static constexpr size_t ROW_BITS = 16;
+    static constexpr size_t ROW_MASK = (size_t(1) << ROW_BITS) - 1;
+    
+    static size_t MakeIndex(size_t chunkIndex, size_t row) { return (chunkIndex << ROW_BITS) | row; }
+    static size_t GetChunkIndex(size_t entityIndex) { return entityIndex >> ROW_BITS; }
+    static size_t GetRow(size_t entityIndex) { return entityIndex & ROW_MASK; }
+    
     struct Chunk {
         uint8_t* data = nullptr;
         size_t entityCount = 0;
         size_t capacity = 0;
+        std::vector<uint32_t> columnVersions;
         
-        Chunk(size_t cap) : capacity(cap) {
-            data = static_cast<uint8_t*>(std::aligned_alloc(64, CHUNK_SIZE));
-            std::memset(data, 0, CHUNK_SIZE);
-        }
-        
-        ~Chunk() {
-            if (data) std::free(data);
-        }
+        Chunk(uint8_t* memory, size_t cap, size_t columnCount, uint32_t version)
+            : data(memory), capacity(cap), columnVersions(columnCount, version)
+        {}
         
         Chunk(const Chunk&) = delete;
         Chunk& operator=(const Chunk&) = delete;
         
         Chunk(Chunk&& other) noexcept
             : data(other.data), entityCount(other.entityCount), capacity(other.capacity)
+            , columnVersions(std::move(other.columnVersions))
         {
             other.data = nullptr;
         }
+        
+        Entity* GetEntities() { return reinterpret_cast<Entity*>(data); }
+        const Entity* GetEntities() const { return reinterpret_cast<const Entity*>(data); }
     };
     
-    Archetype(const std::vector<ComponentInfo>& components);
-    ~Archetype() = default;
+    Archetype(const std::vector<ComponentInfo>& components, ChunkPool& chunkPool,
+              const std::atomic<uint32_t>& changeVersion);
+    ~Archetype();
+    
+    Archetype(const Archetype&) = delete;
+    Archetype& operator=(const Archetype&) = delete;
     
     size_t AddEntity(Entity entity);
-    void RemoveEntity(size_t index);
+    void AddEntities(const Entity* entities, size_t count, const void* const* columnValues, size_t* outIndices,
+                     size_t valueCount = 1);
+    Entity RemoveEntity(size_t index);
+    void MoveEntityTo(size_t index, const ArchetypeEdge& edge, size_t destinationIndex);
+    size_t AppendChunk(size_t entityCount);
+    
+    bool NeedsCompaction() const;
+    size_t Compact(size_t maxMoves, const std::function<void(Entity, size_t)>& onMoved);
+    
+    const ArchetypeEdge* FindAddEdge(ComponentTypeID typeID) const {
+        return FindEdge(m_AddEdges, typeID);
+    }
+    
+    const ArchetypeEdge* FindRemoveEdge(ComponentTypeID typeID) const {
+        return FindEdge(m_RemoveEdges, typeID);
+    }
+    
+    const ArchetypeEdge& SetAddEdge(ComponentTypeID typeID, Archetype* target);
+    const ArchetypeEdge& SetRemoveEdge(ComponentTypeID typeID, Archetype* target);
+    void ForgetRetiredEdges();
+    
+    static ArchetypeEdge BuildEdge(const Archetype* source, Archetype* target);
     
     void* GetComponent(size_t entityIndex, ComponentTypeID typeID);
     const void* GetComponent(size_t entityIndex, ComponentTypeID typeID) const;
@@ -61,8 +110,81 @@ public:
         return static_cast<T*>(GetComponent(entityIndex, ComponentRegistry::GetTypeID<T>()));
     }
     
+    template<typename T>
+    const T* GetComponent(size_t entityIndex) const {
+        return static_cast<const T*>(GetComponent(entityIndex, ComponentRegistry::GetTypeID<T>()));
+    }
+    
+    bool HasComponent(ComponentTypeID typeID) const {
+        return m_Signature.test(typeID);
+    }
+    
+    size_t GetComponentIndex(ComponentTypeID typeID) const {
+        uint8_t column = m_ColumnLookup[typeID];
+        return column != NO_COLUMN ? column : INVALID_COLUMN;
+    }
+    
+    const ComponentSignature& GetSignature() const { return m_Signature; }
+    
+    Entity GetEntity(size_t entityIndex) const;
+    
     size_t GetEntityCount() const;
     size_t GetChunkCount() const { return m_Chunks.size(); }
+    size_t GetEntitiesPerChunk() const { return m_EntitiesPerChunk; }
+    
+    Chunk& GetChunk(size_t chunkIndex) { return *m_Chunks[chunkIndex]; }
+    const Chunk& GetChunk(size_t chunkIndex) const { return *m_Chunks[chunkIndex]; }
+    
+    void* GetColumn(Chunk& chunk, size_t componentIndex) {
+        const ComponentInfo& info = m_ComponentTypes[componentIndex];
+        if (info.sharedValue) return const_cast<void*>(info.sharedValue);
+        return chunk.data + info.offsetInChunk;
+    }
+    
+    const void* GetSharedComponent(ComponentTypeID typeID) const {
+        size_t index = GetComponentIndex(typeID);
+        return index != INVALID_COLUMN ? m_ComponentTypes[index].sharedValue : nullptr;
+    }
+    
+    template<typename T>
+    const T* GetSharedComponent() const {
+        return static_cast<const T*>(GetSharedComponent(ComponentRegistry::GetTypeID<T>()));
+    }
+    
+    const std::shared_ptr<const void>& GetSharedValue(size_t componentIndex) const {
+        return m_SharedValues[componentIndex];
+    }
+    
+    void SetSharedValue(size_t componentIndex, std::shared_ptr<const void> value);
+    void ReleaseSharedValues();
+    bool HasSharedComponents() const { return m_HasSharedComponents; }
+    bool IsRetired() const { return m_Retired; }
+    
+    static bool IsNewerVersion(uint32_t version, uint32_t sinceVersion) {
+        return static_cast<int32_t>(version - sinceVersion) > 0;
+    }
+    
+    static uint32_t ExchangeWriteVersion(uint32_t version) {
+        uint32_t previous = s_WriteVersion;
+        s_WriteVersion = version;
+        return previous;
+    }
+    
+    uint32_t GetChangeVersion() const {
+        return s_WriteVersion ? s_WriteVersion : m_ChangeVersion.load(std::memory_order_relaxed) + 1;
+    }
+    
+    void MarkColumnChanged(Chunk& chunk, size_t componentIndex) {
+        chunk.columnVersions[componentIndex] = GetChangeVersion();
+    }
+    
+    void MarkColumnChanged(Chunk& chunk, size_t componentIndex, uint32_t version) {
+        chunk.columnVersions[componentIndex] = version;
+    }
+    
+    bool HasColumnChanged(const Chunk& chunk, size_t componentIndex, uint32_t sinceVersion) const {
+        return IsNewerVersion(chunk.columnVersions[componentIndex], sinceVersion);
+    }
     
     const std::vector<ComponentInfo>& GetComponentTypes() const { return m_ComponentTypes; }
     
@@ -70,12 +192,43 @@ public:
     
 private:
     std::vector<ComponentInfo> m_ComponentTypes;
+    std::vector<std::shared_ptr<const void>> m_SharedValues;
     std::vector<std::unique_ptr<Chunk>> m_Chunks;
-    std::unordered_map<ComponentTypeID, size_t> m_ComponentIndexMap;
+    static constexpr uint8_t NO_COLUMN = 0xFF;
+    
+    ComponentSignature m_Signature;
+    std::array<uint8_t, MAX_COMPONENT_TYPES> m_ColumnLookup;
+    std::vector<ArchetypeEdge> m_AddEdges;
+    std::vector<ArchetypeEdge> m_RemoveEdges;
+    
+    std::vector<size_t> m_ReleasedChunks;
+    size_t m_InsertChunk = ~size_t(0);
+    bool m_HasSharedComponents = false;
+    bool m_Retired = false;
+    
+    ChunkPool& m_ChunkPool;
+    const std::atomic<uint32_t>& m_ChangeVersion;
+    static inline thread_local uint32_t s_WriteVersion = 0;
     
     size_t m_EntitiesPerChunk = 0;
     size_t CalculateEntitiesPerChunk();
-    void AllocateNewChunk();
+    size_t CalculateChunkLayout(size_t entitiesPerChunk);
+    size_t AcquireInsertChunk();
+    void ReleaseChunk(size_t chunkIndex);
+    void TrimReleasedChunks();
+    void MoveRow(Chunk& src, size_t srcRow, Chunk& dst, size_t dstRow);
+    void DestroyComponents(Chunk& chunk, size_t indexInChunk);
+    void FillColumn(Chunk& chunk, size_t componentIndex, size_t first, size_t count,
+                    const void* values, size_t valueCount, size_t phase);
+    void MarkChunkChanged(Chunk& chunk);
+    
+    static const ArchetypeEdge* FindEdge(const std::vector<ArchetypeEdge>& edges, ComponentTypeID typeID) {
+        if (typeID >= edges.size() || !edges[typeID].cached) return nullptr;
+        return &edges[typeID];
+    }
+    
+    static const ArchetypeEdge& SetEdge(std::vector<ArchetypeEdge>& edges, ComponentTypeID typeID,
+                                        const Archetype* source, Archetype* target);
 };
 
 }
@@ -0,0 +1,113 @@
+#include "ChunkPool.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace Orchard::ECS {
+
+ChunkPool::~ChunkPool() {
+    assert(m_UsedChunks == 0 && "ChunkPool destroyed while chunks are still in use");
+    
+    for (const Slab& slab : m_Slabs) {
+        std::free(slab.allocation);
+    }
+}
+
+void ChunkPool::AllocateSlab() {
+    void* allocation = std::calloc(1, SLAB_SIZE + CHUNK_SIZE);
+    if (!allocation) {
+        throw std::bad_alloc();
+    }
+    
+    uintptr_t address = reinterpret_cast<uintptr_t>(allocation);
+    uint8_t* base = reinterpret_cast<uint8_t*>((address + CHUNK_SIZE - 1) & ~uintptr_t(CHUNK_SIZE - 1));
+    
+    m_Slabs.push_back(Slab{ allocation, base });
+    for (size_t i = CHUNKS_PER_SLAB; i > 0; --i) {
+        m_FreeChunks.push_back(FreeChunk{ base + (i - 1) * CHUNK_SIZE, true });
+    }
+}
+
+uint8_t* ChunkPool::Allocate(bool zeroed) {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    
+    if (m_FreeChunks.empty()) {
+        AllocateSlab();
+    }
+    
+    FreeChunk chunk = m_FreeChunks.back();
+    m_FreeChunks.pop_back();
+    
+    if (zeroed && !chunk.zeroed) {
+        std::memset(chunk.memory, 0, CHUNK_SIZE);
+        ++m_ZeroFills;
+    }
+    
+    ++m_UsedChunks;
+    m_PeakUsedChunks = std::max(m_PeakUsedChunks, m_UsedChunks);
+    return chunk.memory;
+}
+
+void ChunkPool::Deallocate(uint8_t* chunk) {
+    if (!chunk) return;
+    
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_FreeChunks.push_back(FreeChunk{ chunk, false });
+    --m_UsedChunks;
+}
+
+size_t ChunkPool::Trim() {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    
+    std::sort(m_Slabs.begin(), m_Slabs.end(),
+        [](const Slab& a, const Slab& b) {
+            return a.base < b.base;
+        });
+    std::sort(m_FreeChunks.begin(), m_FreeChunks.end(),
+        [](const FreeChunk& a, const FreeChunk& b) {
+            return a.memory < b.memory;
+        });
+    
+    std::vector<Slab> keptSlabs;
+    std::vector<FreeChunk> keptChunks;
+    size_t released = 0;
+    size_t cursor = 0;
+    for (const Slab& slab : m_Slabs) {
+        size_t first = cursor;
+        while (cursor < m_FreeChunks.size() && m_FreeChunks[cursor].memory < slab.base + SLAB_SIZE) {
+            ++cursor;
+        }
+        
+        if (cursor - first == CHUNKS_PER_SLAB) {
+            std::free(slab.allocation);
+            ++released;
+            continue;
+        }
+        
+        keptSlabs.push_back(slab);
+        keptChunks.insert(keptChunks.end(), m_FreeChunks.begin() + first, m_FreeChunks.begin() + cursor);
+    }
+    
+    m_Slabs = std::move(keptSlabs);
+    m_FreeChunks = std::move(keptChunks);
+    return released;
+}
+
+ChunkPoolStats ChunkPool::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    
+    ChunkPoolStats stats;
+    stats.slabCount = m_Slabs.size();
+    stats.totalChunks = m_Slabs.size() * CHUNKS_PER_SLAB;
+    stats.usedChunks = m_UsedChunks;
+    stats.freeChunks = m_FreeChunks.size();
+    stats.reservedBytes = m_Slabs.size() * SLAB_SIZE;
+    stats.usedBytes = m_UsedChunks * CHUNK_SIZE;
+    stats.peakUsedChunks = m_PeakUsedChunks;
+    stats.zeroFills = m_ZeroFills;
+    return stats;
+}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Orchard::ECS {
+
+constexpr size_t CHUNK_SIZE = 16384;
+constexpr size_t CHUNK_COLUMN_ALIGNMENT = 64;
+constexpr size_t CHUNKS_PER_SLAB = 64;
+constexpr size_t SLAB_SIZE = CHUNK_SIZE * CHUNKS_PER_SLAB;
+
+struct ChunkPoolStats {
+    size_t slabCount = 0;
+    size_t totalChunks = 0;
+    size_t usedChunks = 0;
+    size_t freeChunks = 0;
+    size_t reservedBytes = 0;
+    size_t usedBytes = 0;
+    size_t peakUsedChunks = 0;
+    size_t zeroFills = 0;
+};
+
+class ChunkPool {
+public:
+    ChunkPool() = default;
+    ~ChunkPool();
+    
+    ChunkPool(const ChunkPool&) = delete;
+    ChunkPool& operator=(const ChunkPool&) = delete;
+    
+    uint8_t* Allocate(bool zeroed = false);
+    void Deallocate(uint8_t* chunk);
+    
+    size_t Trim();
+    
+    ChunkPoolStats GetStats() const;
+    
+private:
+    struct Slab {
+        void* allocation;
+        uint8_t* base;
+    };
+    
+    struct FreeChunk {
+        uint8_t* memory;
+        bool zeroed;
+    };
+    
+    void AllocateSlab();
+    
+    std::vector<Slab> m_Slabs;
+    std::vector<FreeChunk> m_FreeChunks;
+    size_t m_UsedChunks = 0;
+    size_t m_PeakUsedChunks = 0;
+    size_t m_ZeroFills = 0;
+    mutable std::mutex m_Mutex;
+};
+
+}
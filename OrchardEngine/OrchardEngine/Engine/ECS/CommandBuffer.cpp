@@ -0,0 +1,64 @@
+#include "CommandBuffer.hpp"
+#include <algorithm>
+
+namespace Orchard::ECS {
+
+EntityCommandBuffer::~EntityCommandBuffer() {
+    Clear();
+}
+
+Entity EntityCommandBuffer::CreateEntity() {
+    Entity placeholder(DEFERRED_ENTITY_BIT | (EntityID(m_BufferIndex) << 32) | m_CreatedCount++, 0);
+    m_Commands.push_back(Command{ CommandType::CreateEntity, placeholder, INVALID_COMPONENT_TYPE, nullptr });
+    return placeholder;
+}
+
+void EntityCommandBuffer::DestroyEntity(Entity entity) {
+    m_Commands.push_back(Command{ CommandType::DestroyEntity, entity, INVALID_COMPONENT_TYPE, nullptr });
+}
+
+void* EntityCommandBuffer::AllocatePayload(size_t size, size_t alignment) {
+    while (m_PageIndex < m_Pages.size()) {
+        Page& page = m_Pages[m_PageIndex];
+        uintptr_t base = reinterpret_cast<uintptr_t>(page.memory.get());
+        uintptr_t aligned = (base + m_PageOffset + alignment - 1) & ~(uintptr_t(alignment) - 1);
+        size_t offset = aligned - base;
+        
+        if (offset + size <= page.size) {
+            m_PageOffset = offset + size;
+            return reinterpret_cast<void*>(aligned);
+        }
+        
+        ++m_PageIndex;
+        m_PageOffset = 0;
+    }
+    
+    size_t pageSize = std::max(PAGE_SIZE, size + alignment);
+    m_Pages.push_back(Page{ std::make_unique<uint8_t[]>(pageSize), pageSize });
+    m_PageIndex = m_Pages.size() - 1;
+    m_PageOffset = 0;
+    
+    return AllocatePayload(size, alignment);
+}
+
+void EntityCommandBuffer::Clear() {
+    for (const Command& command : m_Commands) {
+        if (command.type == CommandType::AddComponent) {
+            const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(command.typeID);
+            if (!typeInfo.trivialValue) {
+                typeInfo.destroy(command.data);
+            }
+        }
+    }
+    
+    Reset();
+}
+
+void EntityCommandBuffer::Reset() {
+    m_Commands.clear();
+    m_PageIndex = 0;
+    m_PageOffset = 0;
+    m_CreatedCount = 0;
+}
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "Component.hpp"
+#include "Entity.hpp"
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace Orchard::ECS {
+
+class World;
+
+constexpr EntityID DEFERRED_ENTITY_BIT = EntityID(1) << 63;
+
+class EntityCommandBuffer {
+public:
+    enum class CommandType : uint8_t {
+        CreateEntity,
+        DestroyEntity,
+        AddComponent,
+        RemoveComponent
+    };
+    
+    struct Command {
+        CommandType type;
+        Entity entity;
+        ComponentTypeID typeID;
+        void* data;
+    };
+    
+    explicit EntityCommandBuffer(uint32_t bufferIndex = 0) : m_BufferIndex(bufferIndex) {}
+    ~EntityCommandBuffer();
+    
+    EntityCommandBuffer(const EntityCommandBuffer&) = delete;
+    EntityCommandBuffer& operator=(const EntityCommandBuffer&) = delete;
+    
+    Entity CreateEntity();
+    void DestroyEntity(Entity entity);
+    
+    template<typename T>
+    void AddComponent(Entity entity, const T& component);
+    
+    template<typename T>
+    void RemoveComponent(Entity entity);
+    
+    void Clear();
+    
+    bool IsEmpty() const { return m_Commands.empty(); }
+    size_t GetCommandCount() const { return m_Commands.size(); }
+    size_t GetCreatedEntityCount() const { return m_CreatedCount; }
+    const std::vector<Command>& GetCommands() const { return m_Commands; }
+    
+    uint32_t GetBufferIndex() const { return m_BufferIndex; }
+    
+    static bool IsDeferred(Entity entity) { return (entity.id & DEFERRED_ENTITY_BIT) != 0; }
+    static uint32_t GetDeferredBuffer(Entity entity) { return static_cast<uint32_t>((entity.id & ~DEFERRED_ENTITY_BIT) >> 32); }
+    static size_t GetDeferredIndex(Entity entity) { return static_cast<uint32_t>(entity.id); }
+    
+private:
+    friend class World;
+    
+    static constexpr size_t PAGE_SIZE = 16384;
+    
+    struct Page {
+        std::unique_ptr<uint8_t[]> memory;
+        size_t size;
+    };
+    
+    void* AllocatePayload(size_t size, size_t alignment);
+    void Reset();
+    
+    std::vector<Command> m_Commands;
+    std::vector<Page> m_Pages;
+    size_t m_PageIndex = 0;
+    size_t m_PageOffset = 0;
+    size_t m_CreatedCount = 0;
+    uint32_t m_BufferIndex = 0;
+};
+
+template<typename T>
+void EntityCommandBuffer::AddComponent(Entity entity, const T& component) {
+    ComponentTypeID typeID = ComponentRegistry::GetTypeID<T>();
+    void* data = AllocatePayload(sizeof(T), alignof(T));
+    new (data) T(component);
+    m_Commands.push_back(Command{ CommandType::AddComponent, entity, typeID, data });
+}
+
+template<typename T>
+void EntityCommandBuffer::RemoveComponent(Entity entity) {
+    m_Commands.push_back(Command{ CommandType::RemoveComponent, entity, ComponentRegistry::GetTypeID<T>(), nullptr });
+}
+
+}
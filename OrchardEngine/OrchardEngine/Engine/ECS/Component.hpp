@@ -1,35 +1,238 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <cstddef>
 #include <cstdint>
-#include <typeindex>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
 #include <string>
+#include <string_view>
+#include <utility>
 
 namespace Orchard::ECS {
 
 using ComponentTypeID = uint32_t;
 
+constexpr size_t MAX_COMPONENT_TYPES = 256;
+constexpr ComponentTypeID INVALID_COMPONENT_TYPE = ~ComponentTypeID(0);
+constexpr uint32_t INVALID_SHARED_INDEX = ~uint32_t(0);
+
+using ComponentSignature = std::bitset<MAX_COMPONENT_TYPES>;
+
+struct SharedComponent {};
+struct SparseComponent {};
+
+namespace Detail {
+
+constexpr uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ull;
+
+constexpr uint64_t HashName(std::string_view name) {
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+template<typename T>
+constexpr std::string_view GetQualifiedTypeName() {
+    std::string_view signature = __PRETTY_FUNCTION__;
+    size_t begin = signature.find("T = ") + 4;
+    size_t end = signature.find(';', begin);
+    if (end == std::string_view::npos) {
+        end = signature.rfind(']');
+    }
+    return signature.substr(begin, end - begin);
+}
+
+template<typename T, typename = void>
+struct HasComponentName : std::false_type {};
+
+template<typename T, typename = void>
+struct IsHashable : std::false_type {};
+
+template<typename T>
+struct IsHashable<T, std::void_t<decltype(std::hash<T>{}(std::declval<const T&>()))>> : std::true_type {};
+
+template<typename T>
+size_t HashValue(const T& value) {
+    if constexpr (IsHashable<T>::value) {
+        return std::hash<T>{}(value);
+    } else if constexpr (std::has_unique_object_representations_v<T>) {
+        uint64_t hash = FNV_OFFSET_BASIS;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(T); ++i) {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return static_cast<size_t>(hash);
+    } else {
+        return 0;
+    }
+}
+
+template<typename T>
+struct HasComponentName<T, std::void_t<decltype(T::ComponentName)>> : std::true_type {};
+
+}
+
+// Components declare `static constexpr std::string_view ComponentName` to keep their stable
+// ID across compilers and renames; WorldSerializer only saves components that do.
+template<typename T>
+constexpr std::string_view GetComponentName() {
+    if constexpr (Detail::HasComponentName<T>::value) {
+        return T::ComponentName;
+    } else {
+        return Detail::GetQualifiedTypeName<T>();
+    }
+}
+
+template<typename T>
+constexpr uint64_t GetStableTypeID() {
+    return Detail::HashName(GetComponentName<T>());
+}
+
+struct ComponentTypeInfo {
+    ComponentTypeID id = INVALID_COMPONENT_TYPE;
+    uint64_t stableID = 0;
+    size_t size = 0;
+    size_t valueSize = 0;
+    size_t alignment = 0;
+    const char* name = nullptr;
+    bool trivial = true;
+    bool tag = false;
+    bool shared = false;
+    bool sparse = false;
+    bool trivialValue = true;
+    bool named = false;
+    
+    void (*defaultConstruct)(void* dst) = nullptr;
+    void (*moveConstruct)(void* dst, void* src) = nullptr;
+    void (*copyConstruct)(void* dst, const void* src) = nullptr;
+    void (*destroy)(void* ptr) = nullptr;
+    bool (*equals)(const void* a, const void* b) = nullptr;
+    size_t (*hash)(const void* value) = nullptr;
+};
+
 class ComponentRegistry {
 public:
     template<typename T>
     static ComponentTypeID GetTypeID() {
-        static ComponentTypeID id = s_NextID++;
+        static ComponentTypeID id = Register<T>();
         return id;
     }
     
     template<typename T>
     static const char* GetTypeName() {
-        return typeid(T).name();
+        static const std::string name(GetComponentName<T>());
+        return name.c_str();
+    }
+    
+    static const ComponentTypeInfo& GetTypeInfo(ComponentTypeID id) {
+        return s_Infos[id];
+    }
+    
+    static size_t GetTypeCount() {
+        return s_Count.load(std::memory_order_acquire);
+    }
+    
+    static ComponentTypeID FindTypeID(uint64_t stableID) {
+        size_t count = GetTypeCount();
+        for (size_t i = 0; i < count; ++i) {
+            if (s_Infos[i].stableID == stableID) {
+                return static_cast<ComponentTypeID>(i);
+            }
+        }
+        return INVALID_COMPONENT_TYPE;
     }
     
 private:
-    static inline ComponentTypeID s_NextID = 0;
+    template<typename T>
+    static ComponentTypeID Register();
+    
+    static inline std::array<ComponentTypeInfo, MAX_COMPONENT_TYPES> s_Infos{};
+    static inline std::atomic<uint32_t> s_Count{0};
+    static inline std::mutex s_Mutex;
 };
 
 template<typename T>
 struct ComponentTrait {
     static constexpr bool is_component = true;
-    static constexpr size_t size = sizeof(T);
+    static constexpr bool is_shared = std::is_base_of_v<SharedComponent, T>;
+    static constexpr bool is_sparse = std::is_base_of_v<SparseComponent, T>;
+    static constexpr bool is_tag = std::is_empty_v<T> && !is_shared && !is_sparse;
+    static constexpr size_t size = (is_tag || is_shared || is_sparse) ? 0 : sizeof(T);
     static constexpr size_t alignment = alignof(T);
 };
 
+template<typename T>
+ComponentTypeID ComponentRegistry::Register() {
+    static_assert(std::is_move_constructible_v<T>, "Components must be move constructible");
+    static_assert(!(ComponentTrait<T>::is_shared && ComponentTrait<T>::is_sparse), "A component cannot be both shared and sparse");
+    
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    
+    uint32_t id = s_Count.load(std::memory_order_relaxed);
+    if (id >= MAX_COMPONENT_TYPES) {
+        throw std::length_error("ComponentRegistry: MAX_COMPONENT_TYPES exceeded");
+    }
+    
+    constexpr uint64_t stableID = GetStableTypeID<T>();
+    for (uint32_t i = 0; i < id; ++i) {
+        if (s_Infos[i].stableID == stableID) {
+            throw std::logic_error(std::string("ComponentRegistry: stable ID of ") + GetTypeName<T>() +
+                                   " collides with " + s_Infos[i].name);
+        }
+    }
+    
+    ComponentTypeInfo& info = s_Infos[id];
+    info.id = id;
+    info.stableID = stableID;
+    info.size = ComponentTrait<T>::size;
+    info.valueSize = sizeof(T);
+    info.alignment = ComponentTrait<T>::alignment;
+    info.name = GetTypeName<T>();
+    info.named = Detail::HasComponentName<T>::value;
+    info.trivial = ComponentTrait<T>::is_tag || ComponentTrait<T>::is_shared || std::is_trivially_copyable_v<T>;
+    info.tag = ComponentTrait<T>::is_tag;
+    info.shared = ComponentTrait<T>::is_shared;
+    info.sparse = ComponentTrait<T>::is_sparse;
+    info.trivialValue = std::is_trivially_copyable_v<T>;
+    if constexpr (std::is_default_constructible_v<T>) {
+        info.defaultConstruct = [](void* dst) {
+            new (dst) T();
+        };
+    }
+    info.moveConstruct = [](void* dst, void* src) {
+        new (dst) T(std::move(*static_cast<T*>(src)));
+    };
+    if constexpr (std::is_copy_constructible_v<T>) {
+        info.copyConstruct = [](void* dst, const void* src) {
+            new (dst) T(*static_cast<const T*>(src));
+        };
+    }
+    info.destroy = [](void* ptr) {
+        static_cast<T*>(ptr)->~T();
+    };
+    if constexpr (ComponentTrait<T>::is_shared) {
+        static_assert(std::is_copy_constructible_v<T>, "Shared components must be copy constructible");
+        info.equals = [](const void* a, const void* b) {
+            return *static_cast<const T*>(a) == *static_cast<const T*>(b);
+        };
+        info.hash = [](const void* value) {
+            return Detail::HashValue(*static_cast<const T*>(value));
+        };
+    }
+    
+    s_Count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
 }
@@ -1,17 +1,16 @@
 #pragma once
 
+#include "../Component.hpp"
+#include "../Entity.hpp"
 #include "../../Math/Transform.hpp"
+#include "../../Utils/UUID.hpp"
 
 namespace Orchard::ECS {
 
 struct TransformComponent {
-    Math::Transform transform;
-    Entity parent;
-    std::vector<Entity> children;
+    static constexpr std::string_view ComponentName = "Orchard::ECS::TransformComponent";
     
-    TransformComponent()
-        : parent()
-    {}
+    Math::Transform transform;
     
     const Math::Vector3& GetPosition() const { return transform.GetPosition(); }
     const Math::Quaternion& GetRotation() const { return transform.GetRotation(); }
@@ -21,12 +20,38 @@ struct TransformComponent {
     void SetRotation(const Math::Quaternion& rot) { transform.SetRotation(rot); }
     void SetScale(const Math::Vector3& scale) { transform.SetScale(scale); }
     
-    Math::Matrix4 GetWorldMatrix() const {
+    Math::Matrix4 GetLocalMatrix() const {
         return transform.GetMatrix();
     }
 };
 
+struct Parent {
+    static constexpr std::string_view ComponentName = "Orchard::ECS::Parent";
+    
+    Entity entity;
+};
+
+struct HierarchyDepth : SharedComponent {
+    static constexpr std::string_view ComponentName = "Orchard::ECS::HierarchyDepth";
+    
+    uint32_t depth = 0;
+    
+    bool operator==(const HierarchyDepth& other) const { return depth == other.depth; }
+};
+
+struct HierarchyDirty : SparseComponent {
+    static constexpr std::string_view ComponentName = "Orchard::ECS::HierarchyDirty";
+};
+
+struct LocalToWorld {
+    static constexpr std::string_view ComponentName = "Orchard::ECS::LocalToWorld";
+    
+    Math::Matrix4 matrix;
+};
+
 struct MeshRendererComponent {
+    static constexpr std::string_view ComponentName = "Orchard::ECS::MeshRendererComponent";
+    
     UUID meshID;
     UUID materialID;
     bool castShadows = true;
@@ -34,6 +59,8 @@ struct MeshRendererComponent {
 };
 
 struct CameraComponent {
+    static constexpr std::string_view ComponentName = "Orchard::ECS::CameraComponent";
+    
     float fov = 60.0f;
     float nearPlane = 0.1f;
     float farPlane = 1000.0f;
@@ -50,6 +77,8 @@ struct CameraComponent {
 };
 
 struct LightComponent {
+    static constexpr std::string_view ComponentName = "Orchard::ECS::LightComponent";
+    
     enum class Type {
         Directional,
         Point,
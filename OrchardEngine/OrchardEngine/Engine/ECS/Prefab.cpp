@@ -0,0 +1,35 @@
+#include "Prefab.hpp"
+#include <new>
+
+namespace Orchard::ECS {
+
+Prefab::~Prefab() {
+    for (Group& group : m_Groups) {
+        const auto& components = group.archetype->GetComponentTypes();
+        for (size_t c = 0; c < group.columns.size(); ++c) {
+            if (!group.columns[c]) continue;
+            
+            const ComponentInfo& info = components[c];
+            const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(info.typeID);
+            if (!typeInfo.trivial) {
+                for (size_t r = 0; r < group.members.size(); ++r) {
+                    typeInfo.destroy(static_cast<uint8_t*>(group.columns[c]) + r * info.size);
+                }
+            }
+            ::operator delete(group.columns[c], std::align_val_t(info.alignment));
+        }
+    }
+}
+
+Prefab::Group& Prefab::GetGroup(Archetype* archetype) {
+    for (Group& group : m_Groups) {
+        if (group.archetype == archetype) return group;
+    }
+    
+    Group& group = m_Groups.emplace_back();
+    group.archetype = archetype;
+    group.columns.assign(archetype->GetComponentTypes().size(), nullptr);
+    return group;
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Archetype.hpp"
+#include <vector>
+
+namespace Orchard::ECS {
+
+using PrefabID = uint32_t;
+
+constexpr PrefabID INVALID_PREFAB = ~PrefabID(0);
+
+class Prefab {
+public:
+    static constexpr uint32_t NO_MEMBER = ~uint32_t(0);
+    
+    struct Group {
+        Archetype* archetype = nullptr;
+        std::vector<uint32_t> members;
+        std::vector<uint32_t> parentMembers;
+        std::vector<void*> columns;
+    };
+    
+    explicit Prefab(size_t memberCount) : m_MemberCount(memberCount) {}
+    ~Prefab();
+    
+    Prefab(const Prefab&) = delete;
+    Prefab& operator=(const Prefab&) = delete;
+    
+    size_t GetMemberCount() const { return m_MemberCount; }
+    
+    std::vector<Group>& GetGroups() { return m_Groups; }
+    const std::vector<Group>& GetGroups() const { return m_Groups; }
+    
+    Group& GetGroup(Archetype* archetype);
+    
+private:
+    size_t m_MemberCount;
+    std::vector<Group> m_Groups;
+};
+
+}
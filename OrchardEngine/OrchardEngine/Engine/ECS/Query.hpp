@@ -0,0 +1,387 @@
+#pragma once
+
+#include "Archetype.hpp"
+#include "SparseSet.hpp"
+#include "../Core/JobSystem.hpp"
+#include <algorithm>
+#include <cassert>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Orchard::ECS {
+
+template<typename T>
+struct Changed {};
+
+template<typename T>
+struct QueryTerm {
+    using Component = std::remove_const_t<T>;
+    using Pointer = T*;
+    static constexpr bool isWrite = !std::is_const_v<T>;
+    static constexpr bool isChangeFilter = false;
+    static constexpr bool isPerChunk = ComponentTrait<Component>::is_shared || ComponentTrait<Component>::is_tag;
+    static constexpr bool isSparse = ComponentTrait<Component>::is_sparse;
+    
+    static T& Element(Pointer column, size_t index) {
+        if constexpr (isPerChunk) {
+            return *column;
+        } else {
+            return column[index];
+        }
+    }
+};
+
+template<typename T>
+struct QueryTerm<Changed<T>> : QueryTerm<const std::remove_const_t<T>> {
+    static_assert(!QueryTerm<T>::isSparse, "Sparse-set components do not track change versions");
+    static constexpr bool isChangeFilter = true;
+};
+
+class QueryBase {
+public:
+    virtual ~QueryBase() = default;
+};
+
+template<typename... Components>
+class Query : public QueryBase {
+    static_assert(sizeof...(Components) > 0, "Query requires at least one component");
+    static_assert(((!ComponentTrait<typename QueryTerm<Components>::Component>::is_shared || !QueryTerm<Components>::isWrite) && ...),
+                  "Shared components are read-only in queries; use World::SetSharedComponent");
+    
+public:
+    Query(const std::vector<Archetype*>& archetypes, SparseSetStorage& sparseSets)
+        : m_Archetypes(archetypes)
+        , m_TypeIDs{ ComponentRegistry::GetTypeID<typename QueryTerm<Components>::Component>()... }
+    {
+        for (size_t i = 0; i < COMPONENT_COUNT; ++i) {
+            if (s_IsSparse[i]) {
+                m_SparseSets[i] = &sparseSets.GetOrCreate(m_TypeIDs[i]);
+            } else {
+                m_Signature.set(m_TypeIDs[i]);
+            }
+        }
+    }
+    
+    template<typename Func>
+    void ForEachChunk(Func&& func) {
+        ForEachChunk(0, std::forward<Func>(func));
+    }
+    
+    template<typename Func>
+    void ForEachChunk(uint32_t changedSince, Func&& func);
+    
+    template<typename Func>
+    void ParallelForEachChunk(JobSystem& jobSystem, Func&& func) {
+        ParallelForEachChunk(jobSystem, 0, std::forward<Func>(func));
+    }
+    
+    template<typename Func>
+    void ParallelForEachChunk(JobSystem& jobSystem, uint32_t changedSince, Func&& func);
+    
+    template<typename Func>
+    void ForEach(Func&& func) {
+        ForEach(0, std::forward<Func>(func));
+    }
+    
+    template<typename Func>
+    void ForEach(uint32_t changedSince, Func&& func);
+    
+    template<typename Func>
+    void ForEachInBucket(uint32_t changedSince, uint32_t bucketCount, uint32_t bucket, Func&& func);
+    
+    size_t GetArchetypeCount() {
+        return Refresh().size();
+    }
+    
+    size_t GetEntityCount();
+    
+private:
+    static constexpr size_t COMPONENT_COUNT = sizeof...(Components);
+    static constexpr std::array<bool, COMPONENT_COUNT> s_IsWrite{ QueryTerm<Components>::isWrite... };
+    static constexpr std::array<bool, COMPONENT_COUNT> s_IsChangeFilter{ QueryTerm<Components>::isChangeFilter... };
+    static constexpr bool s_HasChangeFilter = (QueryTerm<Components>::isChangeFilter || ...);
+    static constexpr std::array<bool, COMPONENT_COUNT> s_IsSparse{ QueryTerm<Components>::isSparse... };
+    static constexpr bool s_HasSparse = (QueryTerm<Components>::isSparse || ...);
+    static constexpr bool s_AllSparse = (QueryTerm<Components>::isSparse && ...);
+    
+    struct MatchedArchetype {
+        Archetype* archetype;
+        std::array<size_t, COMPONENT_COUNT> columns;
+    };
+    
+    struct MatchList {
+        std::shared_ptr<const MatchedArchetype[]> storage;
+        size_t count = 0;
+        
+        const MatchedArchetype* begin() const { return storage.get(); }
+        const MatchedArchetype* end() const { return storage.get() + count; }
+        size_t size() const { return count; }
+        const MatchedArchetype& operator[](size_t index) const { return storage[index]; }
+    };
+    
+    MatchList Refresh();
+    
+    bool ContainsSparse(Entity entity) const {
+        for (size_t i = 0; i < COMPONENT_COUNT; ++i) {
+            if (s_IsSparse[i] && !m_SparseSets[i]->Contains(entity.id)) return false;
+        }
+        return true;
+    }
+    
+    template<typename Term>
+    auto& Fetch(size_t term, void* column, size_t row, Entity entity) const {
+        using Pointer = typename QueryTerm<Term>::Pointer;
+        if constexpr (QueryTerm<Term>::isSparse) {
+            return *static_cast<Pointer>(m_SparseSets[term]->Get(entity.id));
+        } else {
+            return QueryTerm<Term>::Element(static_cast<Pointer>(column), row);
+        }
+    }
+    
+    template<typename Func, size_t... I>
+    void InvokeEntity(Func& func, Entity entity, const std::array<void*, COMPONENT_COUNT>& columns, size_t row,
+                      std::index_sequence<I...>) const {
+        func(entity, Fetch<Components>(I, columns[I], row, entity)...);
+    }
+    
+    template<typename Func>
+    void ForEachSparse(uint32_t changedSince, Func& func);
+    
+    bool PassesChangeFilter(const MatchedArchetype& match, const Archetype::Chunk& chunk, uint32_t changedSince) const {
+        if (!s_HasChangeFilter) return true;
+        
+        for (size_t i = 0; i < COMPONENT_COUNT; ++i) {
+            if (s_IsChangeFilter[i] && match.archetype->HasColumnChanged(chunk, match.columns[i], changedSince)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void MarkWrites(const MatchedArchetype& match, Archetype::Chunk& chunk) const {
+        for (size_t i = 0; i < COMPONENT_COUNT; ++i) {
+            if (s_IsWrite[i] && !s_IsSparse[i]) {
+                match.archetype->MarkColumnChanged(chunk, match.columns[i]);
+            }
+        }
+    }
+    
+    template<typename Func, size_t... I>
+    void InvokeChunk(Func& func, const MatchedArchetype& match, Archetype::Chunk& chunk,
+                     std::index_sequence<I...>) {
+        func(chunk.entityCount, static_cast<const Entity*>(chunk.GetEntities()),
+             static_cast<typename QueryTerm<Components>::Pointer>(match.archetype->GetColumn(chunk, match.columns[I]))...);
+    }
+    
+    const std::vector<Archetype*>& m_Archetypes;
+    std::array<ComponentTypeID, COMPONENT_COUNT> m_TypeIDs;
+    std::array<SparseSet*, COMPONENT_COUNT> m_SparseSets{};
+    ComponentSignature m_Signature;
+    std::shared_ptr<MatchedArchetype[]> m_MatchStorage;
+    size_t m_MatchCapacity = 0;
+    std::atomic<size_t> m_MatchCount{0};
+    std::atomic<size_t> m_ArchetypeCursor{0};
+    std::mutex m_RefreshMutex;
+};
+
+template<typename... Components>
+typename Query<Components...>::MatchList Query<Components...>::Refresh() {
+    if (m_ArchetypeCursor.load(std::memory_order_acquire) == m_Archetypes.size()) {
+        size_t count = m_MatchCount.load(std::memory_order_acquire);
+        return MatchList{ std::atomic_load(&m_MatchStorage), count };
+    }
+    
+    std::lock_guard<std::mutex> lock(m_RefreshMutex);
+    size_t count = m_MatchCount.load(std::memory_order_relaxed);
+    size_t cursor = m_ArchetypeCursor.load(std::memory_order_relaxed);
+    for (; cursor < m_Archetypes.size(); ++cursor) {
+        Archetype* archetype = m_Archetypes[cursor];
+        if ((archetype->GetSignature() & m_Signature) != m_Signature) continue;
+        
+        MatchedArchetype match{ archetype, {} };
+        for (size_t i = 0; i < COMPONENT_COUNT; ++i) {
+            match.columns[i] = s_IsSparse[i] ? Archetype::INVALID_COLUMN : archetype->GetComponentIndex(m_TypeIDs[i]);
+        }
+        
+        // Readers only look at the first m_MatchCount entries, so appending in place is safe;
+        // a full array is replaced and the old one lives on with the readers still holding it.
+        if (count == m_MatchCapacity) {
+            size_t capacity = std::max<size_t>(8, m_MatchCapacity * 2);
+            std::shared_ptr<MatchedArchetype[]> storage(new MatchedArchetype[capacity]);
+            std::copy(m_MatchStorage.get(), m_MatchStorage.get() + count, storage.get());
+            std::atomic_store(&m_MatchStorage, storage);
+            m_MatchCapacity = capacity;
+        }
+        m_MatchStorage[count++] = match;
+    }
+    
+    m_MatchCount.store(count, std::memory_order_release);
+    m_ArchetypeCursor.store(m_Archetypes.size(), std::memory_order_release);
+    return MatchList{ m_MatchStorage, count };
+}
+
+template<typename... Components>
+template<typename Func>
+void Query<Components...>::ForEachChunk(uint32_t changedSince, Func&& func) {
+    static_assert(!s_HasSparse, "Sparse-set components can only be iterated with ForEach");
+    auto matches = Refresh();
+    
+    for (const auto& match : matches) {
+        size_t chunkCount = match.archetype->GetChunkCount();
+        for (size_t c = 0; c < chunkCount; ++c) {
+            Archetype::Chunk& chunk = match.archetype->GetChunk(c);
+            if (chunk.entityCount == 0) continue;
+            if (!PassesChangeFilter(match, chunk, changedSince)) continue;
+            
+            MarkWrites(match, chunk);
+            InvokeChunk(func, match, chunk, std::index_sequence_for<Components...>{});
+        }
+    }
+}
+
+template<typename... Components>
+template<typename Func>
+void Query<Components...>::ParallelForEachChunk(JobSystem& jobSystem, uint32_t changedSince, Func&& func) {
+    static_assert(!s_HasSparse, "Sparse-set components can only be iterated with ForEach");
+    auto matches = Refresh();
+    
+    std::vector<std::pair<const MatchedArchetype*, Archetype::Chunk*>> workList;
+    for (const auto& match : matches) {
+        size_t chunkCount = match.archetype->GetChunkCount();
+        for (size_t c = 0; c < chunkCount; ++c) {
+            Archetype::Chunk& chunk = match.archetype->GetChunk(c);
+            if (chunk.entityCount > 0 && PassesChangeFilter(match, chunk, changedSince)) {
+                MarkWrites(match, chunk);
+                workList.emplace_back(&match, &chunk);
+            }
+        }
+    }
+    
+    size_t grainSize = std::max<size_t>(1, workList.size() / (jobSystem.GetThreadCount() * 4));
+    jobSystem.ParallelFor(workList.size(), grainSize, [this, &func, &workList](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto& [match, chunk] = workList[i];
+            InvokeChunk(func, *match, *chunk, std::index_sequence_for<Components...>{});
+        }
+    });
+}
+
+template<typename... Components>
+template<typename Func>
+void Query<Components...>::ForEach(uint32_t changedSince, Func&& func) {
+    if constexpr (s_HasSparse) {
+        ForEachSparse(changedSince, func);
+    } else {
+        ForEachChunk(changedSince, [&func](size_t count, const Entity* entities,
+                                           typename QueryTerm<Components>::Pointer... columns) {
+            for (size_t i = 0; i < count; ++i) {
+                func(entities[i], QueryTerm<Components>::Element(columns, i)...);
+            }
+        });
+    }
+}
+
+template<typename... Components>
+template<typename Func>
+void Query<Components...>::ForEachInBucket(uint32_t changedSince, uint32_t bucketCount, uint32_t bucket, Func&& func) {
+    static_assert(!s_HasSparse, "Sparse-set components can only be iterated with ForEach");
+    assert(bucket < bucketCount);
+    auto matches = Refresh();
+    
+    auto visitBucket = [&func, bucketCount, bucket](size_t count, const Entity* entities,
+                                                     typename QueryTerm<Components>::Pointer... columns) {
+        for (size_t i = 0; i < count; ++i) {
+            if (entities[i].id % bucketCount == bucket) {
+                func(entities[i], QueryTerm<Components>::Element(columns, i)...);
+            }
+        }
+    };
+    
+    for (const auto& match : matches) {
+        size_t chunkCount = match.archetype->GetChunkCount();
+        for (size_t c = 0; c < chunkCount; ++c) {
+            Archetype::Chunk& chunk = match.archetype->GetChunk(c);
+            if (chunk.entityCount == 0) continue;
+            if (!PassesChangeFilter(match, chunk, changedSince)) continue;
+            
+            const Entity* entities = chunk.GetEntities();
+            if (std::none_of(entities, entities + chunk.entityCount,
+                             [bucketCount, bucket](Entity entity) { return entity.id % bucketCount == bucket; })) {
+                continue;
+            }
+            
+            MarkWrites(match, chunk);
+            InvokeChunk(visitBucket, match, chunk, std::index_sequence_for<Components...>{});
+        }
+    }
+}
+
+template<typename... Components>
+template<typename Func>
+void Query<Components...>::ForEachSparse(uint32_t changedSince, Func& func) {
+    std::array<void*, COMPONENT_COUNT> columns{};
+    
+    if constexpr (s_AllSparse) {
+        SparseSet* driver = m_SparseSets[0];
+        for (SparseSet* set : m_SparseSets) {
+            if (set->GetCount() < driver->GetCount()) driver = set;
+        }
+        
+        for (size_t d = 0; d < driver->GetCount(); ++d) {
+            Entity entity = driver->GetEntity(d);
+            if (ContainsSparse(entity)) {
+                InvokeEntity(func, entity, columns, 0, std::index_sequence_for<Components...>{});
+            }
+        }
+    } else {
+        auto matches = Refresh();
+        
+        for (const auto& match : matches) {
+            size_t chunkCount = match.archetype->GetChunkCount();
+            for (size_t c = 0; c < chunkCount; ++c) {
+                Archetype::Chunk& chunk = match.archetype->GetChunk(c);
+                if (chunk.entityCount == 0) continue;
+                if (!PassesChangeFilter(match, chunk, changedSince)) continue;
+                
+                for (size_t i = 0; i < COMPONENT_COUNT; ++i) {
+                    if (s_IsSparse[i]) continue;
+                    columns[i] = match.archetype->GetColumn(chunk, match.columns[i]);
+                    if (s_IsWrite[i]) {
+                        match.archetype->MarkColumnChanged(chunk, match.columns[i]);
+                    }
+                }
+                
+                const Entity* entities = chunk.GetEntities();
+                for (size_t row = 0; row < chunk.entityCount; ++row) {
+                    if (ContainsSparse(entities[row])) {
+                        InvokeEntity(func, entities[row], columns, row, std::index_sequence_for<Components...>{});
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename... Components>
+size_t Query<Components...>::GetEntityCount() {
+    if constexpr (s_HasSparse) {
+        size_t count = 0;
+        ForEach([&count](Entity, auto&...) { ++count; });
+        return count;
+    }
+    
+    auto matches = Refresh();
+    
+    size_t count = 0;
+    for (const auto& match : matches) {
+        count += match.archetype->GetEntityCount();
+    }
+    return count;
+}
+
+}
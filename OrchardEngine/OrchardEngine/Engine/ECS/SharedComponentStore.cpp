@@ -0,0 +1,67 @@
+#include "SharedComponentStore.hpp"
+#include <new>
+
+namespace Orchard::ECS {
+
+uint32_t SharedComponentStore::Intern(ComponentTypeID typeID, const void* value) {
+    const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeID);
+    if (typeID >= m_Types.size()) {
+        m_Types.resize(typeID + 1);
+    }
+    
+    TypeValues& values = m_Types[typeID];
+    size_t hash = typeInfo.hash(value);
+    auto range = values.lookup.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (typeInfo.equals(values.slots[it->second].value.get(), value)) {
+            return it->second;
+        }
+    }
+    
+    void* storage = ::operator new(typeInfo.valueSize, std::align_val_t(typeInfo.alignment));
+    typeInfo.copyConstruct(storage, value);
+    std::shared_ptr<void> stored(storage, [typeID](void* ptr) {
+        const ComponentTypeInfo& info = ComponentRegistry::GetTypeInfo(typeID);
+        info.destroy(ptr);
+        ::operator delete(ptr, std::align_val_t(info.alignment));
+    });
+    
+    uint32_t index;
+    if (!values.freeSlots.empty()) {
+        index = values.freeSlots.back();
+        values.freeSlots.pop_back();
+    } else {
+        index = static_cast<uint32_t>(values.slots.size());
+        values.slots.emplace_back();
+    }
+    
+    values.slots[index] = Slot{ std::move(stored), hash };
+    values.lookup.emplace(hash, index);
+    return index;
+}
+
+size_t SharedComponentStore::ReleaseUnused() {
+    size_t released = 0;
+    for (TypeValues& values : m_Types) {
+        for (uint32_t index = 0; index < values.slots.size(); ++index) {
+            Slot& slot = values.slots[index];
+            if (!slot.value || slot.value.use_count() > 1) continue;
+            
+            auto range = values.lookup.equal_range(slot.hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second == index) {
+                    values.lookup.erase(it);
+                    break;
+                }
+            }
+            
+            slot.value.reset();
+            values.freeSlots.push_back(index);
+            ++released;
+        }
+    }
+    
+    return released;
+}
+
+}
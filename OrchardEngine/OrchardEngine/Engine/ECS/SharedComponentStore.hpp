@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Component.hpp"
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace Orchard::ECS {
+
+class SharedComponentStore {
+public:
+    SharedComponentStore() = default;
+    
+    SharedComponentStore(const SharedComponentStore&) = delete;
+    SharedComponentStore& operator=(const SharedComponentStore&) = delete;
+    
+    uint32_t Intern(ComponentTypeID typeID, const void* value);
+    
+    const void* Get(ComponentTypeID typeID, uint32_t index) const {
+        const Slot* slot = FindSlot(typeID, index);
+        return slot ? slot->value.get() : nullptr;
+    }
+    
+    std::shared_ptr<const void> Acquire(ComponentTypeID typeID, uint32_t index) const {
+        const Slot* slot = FindSlot(typeID, index);
+        return slot ? slot->value : nullptr;
+    }
+    
+    size_t GetValueCount(ComponentTypeID typeID) const {
+        return typeID < m_Types.size() ? m_Types[typeID].lookup.size() : 0;
+    }
+    
+    size_t ReleaseUnused();
+    
+private:
+    struct Slot {
+        std::shared_ptr<void> value;
+        size_t hash = 0;
+    };
+    
+    struct TypeValues {
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+        std::unordered_multimap<size_t, uint32_t> lookup;
+    };
+    
+    const Slot* FindSlot(ComponentTypeID typeID, uint32_t index) const {
+        if (typeID >= m_Types.size() || index >= m_Types[typeID].slots.size()) return nullptr;
+        return &m_Types[typeID].slots[index];
+    }
+    
+    std::vector<TypeValues> m_Types;
+};
+
+}
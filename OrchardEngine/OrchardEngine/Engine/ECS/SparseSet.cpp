@@ -0,0 +1,100 @@
+#include "SparseSet.hpp"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace Orchard::ECS {
+
+SparseSet::SparseSet(ComponentTypeID typeID)
+    : m_TypeID(typeID)
+{
+    const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeID);
+    m_Alignment = std::max<size_t>(typeInfo.alignment, 1);
+    m_Stride = (typeInfo.valueSize + m_Alignment - 1) & ~(m_Alignment - 1);
+}
+
+SparseSet::~SparseSet() {
+    Clear();
+    for (uint8_t* page : m_Pages) {
+        ::operator delete(page, std::align_val_t(m_Alignment));
+    }
+}
+
+void* SparseSet::Emplace(Entity entity) {
+    if (entity.id >= m_Sparse.size()) {
+        m_Sparse.resize(std::max<size_t>(entity.id + 1, m_Sparse.size() * 2), INVALID_INDEX);
+    }
+    
+    size_t denseIndex = m_Entities.size();
+    if ((denseIndex >> PAGE_SHIFT) >= m_Pages.size()) {
+        m_Pages.push_back(static_cast<uint8_t*>(::operator new(m_Stride * PAGE_ELEMENTS, std::align_val_t(m_Alignment))));
+    }
+    
+    m_Sparse[entity.id] = static_cast<uint32_t>(denseIndex);
+    m_Entities.push_back(entity);
+    return GetValue(denseIndex);
+}
+
+bool SparseSet::Remove(EntityID id) {
+    if (!Contains(id)) return false;
+    
+    const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(m_TypeID);
+    size_t denseIndex = m_Sparse[id];
+    size_t lastIndex = m_Entities.size() - 1;
+    void* slot = GetValue(denseIndex);
+    
+    if (!typeInfo.trivialValue) {
+        typeInfo.destroy(slot);
+    }
+    
+    if (denseIndex != lastIndex) {
+        void* last = GetValue(lastIndex);
+        if (typeInfo.trivialValue) {
+            std::memcpy(slot, last, typeInfo.valueSize);
+        } else {
+            typeInfo.moveConstruct(slot, last);
+            typeInfo.destroy(last);
+        }
+        
+        m_Entities[denseIndex] = m_Entities[lastIndex];
+        m_Sparse[m_Entities[denseIndex].id] = static_cast<uint32_t>(denseIndex);
+    }
+    
+    m_Entities.pop_back();
+    m_Sparse[id] = INVALID_INDEX;
+    return true;
+}
+
+void SparseSet::Clear() {
+    const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(m_TypeID);
+    for (size_t i = 0; i < m_Entities.size(); ++i) {
+        if (!typeInfo.trivialValue) {
+            typeInfo.destroy(GetValue(i));
+        }
+        m_Sparse[m_Entities[i].id] = INVALID_INDEX;
+    }
+    m_Entities.clear();
+}
+
+SparseSet& SparseSetStorage::GetOrCreate(ComponentTypeID typeID) {
+    if (SparseSet* set = Find(typeID)) {
+        return *set;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    SparseSet* set = m_Sets[typeID].load(std::memory_order_relaxed);
+    if (!set) {
+        m_OwnedSets.push_back(std::make_unique<SparseSet>(typeID));
+        set = m_OwnedSets.back().get();
+        m_Sets[typeID].store(set, std::memory_order_release);
+    }
+    return *set;
+}
+
+void SparseSetStorage::RemoveEntity(EntityID id) {
+    for (const auto& set : m_OwnedSets) {
+        set->Remove(id);
+    }
+}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "Component.hpp"
+#include "Entity.hpp"
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Orchard::ECS {
+
+class SparseSet {
+public:
+    explicit SparseSet(ComponentTypeID typeID);
+    ~SparseSet();
+    
+    SparseSet(const SparseSet&) = delete;
+    SparseSet& operator=(const SparseSet&) = delete;
+    
+    void* Emplace(Entity entity);
+    bool Remove(EntityID id);
+    void Clear();
+    
+    bool Contains(EntityID id) const {
+        return id < m_Sparse.size() && m_Sparse[id] != INVALID_INDEX;
+    }
+    
+    void* Get(EntityID id) {
+        return Contains(id) ? GetValue(m_Sparse[id]) : nullptr;
+    }
+    
+    const void* Get(EntityID id) const {
+        return Contains(id) ? GetValue(m_Sparse[id]) : nullptr;
+    }
+    
+    size_t GetCount() const { return m_Entities.size(); }
+    Entity GetEntity(size_t denseIndex) const { return m_Entities[denseIndex]; }
+    
+    void* GetValue(size_t denseIndex) const {
+        return m_Pages[denseIndex >> PAGE_SHIFT] + (denseIndex & (PAGE_ELEMENTS - 1)) * m_Stride;
+    }
+    
+    ComponentTypeID GetTypeID() const { return m_TypeID; }
+    
+private:
+    static constexpr uint32_t INVALID_INDEX = ~uint32_t(0);
+    static constexpr size_t PAGE_SHIFT = 8;
+    static constexpr size_t PAGE_ELEMENTS = size_t(1) << PAGE_SHIFT;
+    
+    ComponentTypeID m_TypeID;
+    size_t m_Stride = 0;
+    size_t m_Alignment = 0;
+    
+    std::vector<uint32_t> m_Sparse;
+    std::vector<Entity> m_Entities;
+    std::vector<uint8_t*> m_Pages;
+};
+
+class SparseSetStorage {
+public:
+    SparseSet& GetOrCreate(ComponentTypeID typeID);
+    
+    SparseSet* Find(ComponentTypeID typeID) const {
+        return m_Sets[typeID].load(std::memory_order_acquire);
+    }
+    
+    void RemoveEntity(EntityID id);
+    
+private:
+    std::array<std::atomic<SparseSet*>, MAX_COMPONENT_TYPES> m_Sets{};
+    std::vector<std::unique_ptr<SparseSet>> m_OwnedSets;
+    std::mutex m_Mutex;
+};
+
+}
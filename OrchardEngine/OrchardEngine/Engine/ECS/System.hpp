@@ -1,9 +1,20 @@
 #pragma once
 
+#include "Component.hpp"
+#include <cassert>
+#include <typeinfo>
+#include <vector>
+
 namespace Orchard::ECS {
 
 class World;
 
+struct SystemAccess {
+    std::vector<ComponentTypeID> reads;
+    std::vector<ComponentTypeID> writes;
+    bool exclusive = true;
+};
+
 class System {
 public:
     virtual ~System() = default;
@@ -12,8 +23,69 @@ public:
     virtual void OnUpdate(World* world, double deltaTime) = 0;
     virtual void OnShutdown(World* world) {}
     
+    virtual const char* GetName() const { return typeid(*this).name(); }
+    
+    const SystemAccess& GetAccess() const { return m_Access; }
+    
+    bool IsEnabled() const { return m_Enabled; }
+    void SetEnabled(bool enabled) { m_Enabled = enabled; }
+    
+    uint32_t GetLastRunVersion() const { return m_LastRunVersion; }
+    uint32_t GetRunVersion() const { return m_RunVersion; }
+    
+    uint32_t GetUpdateBuckets() const { return static_cast<uint32_t>(m_BucketTime.size()); }
+    uint32_t GetCurrentBucket() const { return m_CurrentBucket; }
+    uint32_t GetLastBucketRunVersion() const { return m_LastBucketRunVersion; }
+    
 protected:
+    template<typename T>
+    void Reads() {
+        m_Access.reads.push_back(ComponentRegistry::GetTypeID<T>());
+        m_Access.exclusive = false;
+    }
+    
+    template<typename T>
+    void Writes() {
+        m_Access.writes.push_back(ComponentRegistry::GetTypeID<T>());
+        m_Access.exclusive = false;
+    }
+    
+    void SetUpdateBuckets(uint32_t bucketCount) {
+        assert(bucketCount > 0 && "A system needs at least one update bucket");
+        m_BucketTime.assign(bucketCount, 0.0);
+        m_BucketVersions.assign(bucketCount, 0);
+        m_CurrentBucket = bucketCount - 1;
+    }
+    
     bool m_Enabled = true;
+    SystemAccess m_Access;
+    
+private:
+    friend class SystemScheduler;
+    
+    double BeginUpdate(uint32_t version, double deltaTime) {
+        m_LastRunVersion = m_RunVersion;
+        m_RunVersion = version;
+        
+        for (double& time : m_BucketTime) {
+            time += deltaTime;
+        }
+        m_CurrentBucket = (m_CurrentBucket + 1) % m_BucketTime.size();
+        
+        m_LastBucketRunVersion = m_BucketVersions[m_CurrentBucket];
+        m_BucketVersions[m_CurrentBucket] = version;
+        
+        double bucketTime = m_BucketTime[m_CurrentBucket];
+        m_BucketTime[m_CurrentBucket] = 0.0;
+        return bucketTime;
+    }
+    
+    uint32_t m_LastRunVersion = 0;
+    uint32_t m_RunVersion = 0;
+    uint32_t m_LastBucketRunVersion = 0;
+    std::vector<double> m_BucketTime = std::vector<double>(1, 0.0);
+    std::vector<uint32_t> m_BucketVersions = std::vector<uint32_t>(1, 0);
+    uint32_t m_CurrentBucket = 0;
 };
 
 }
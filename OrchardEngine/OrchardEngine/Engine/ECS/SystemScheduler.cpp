@@ -0,0 +1,123 @@
+#include "SystemScheduler.hpp"
+#include "World.hpp"
+#include "../Core/JobSystem.hpp"
+#include <algorithm>
+#include <functional>
+#include <sstream>
+
+namespace Orchard::ECS {
+
+static bool Overlaps(const std::vector<ComponentTypeID>& a, const std::vector<ComponentTypeID>& b) {
+    for (ComponentTypeID typeID : a) {
+        if (std::find(b.begin(), b.end(), typeID) != b.end()) return true;
+    }
+    return false;
+}
+
+bool SystemScheduler::Conflicts(const SystemAccess& a, const SystemAccess& b) {
+    if (a.exclusive || b.exclusive) return true;
+    
+    return Overlaps(a.writes, b.writes) ||
+           Overlaps(a.writes, b.reads) ||
+           Overlaps(a.reads, b.writes);
+}
+
+void SystemScheduler::Build(const std::vector<std::unique_ptr<System>>& systems) {
+    m_Nodes.clear();
+    m_Roots.clear();
+    m_StageCount = 0;
+    
+    for (const auto& system : systems) {
+        auto node = std::make_unique<Node>();
+        node->system = system.get();
+        m_Nodes.push_back(std::move(node));
+    }
+    
+    for (size_t j = 0; j < m_Nodes.size(); ++j) {
+        Node& node = *m_Nodes[j];
+        for (size_t i = 0; i < j; ++i) {
+            if (Conflicts(m_Nodes[i]->system->GetAccess(), node.system->GetAccess())) {
+                node.dependencies.push_back(i);
+                m_Nodes[i]->dependents.push_back(j);
+                node.stage = std::max(node.stage, m_Nodes[i]->stage + 1);
+            }
+        }
+        
+        if (node.dependencies.empty()) {
+            m_Roots.push_back(j);
+        }
+        m_StageCount = std::max(m_StageCount, node.stage + 1);
+    }
+}
+
+void SystemScheduler::RunSystem(World* world, System* system, double deltaTime) {
+    uint32_t version = world->AdvanceChangeVersion();
+    double systemDelta = system->BeginUpdate(version, deltaTime);
+    
+    uint32_t previous = Archetype::ExchangeWriteVersion(version);
+    system->OnUpdate(world, systemDelta);
+    Archetype::ExchangeWriteVersion(previous);
+}
+
+void SystemScheduler::Run(World* world, double deltaTime, JobSystem* jobSystem) {
+    if (!jobSystem || jobSystem->GetWorkerCount() == 0) {
+        for (const auto& node : m_Nodes) {
+            if (node->system->IsEnabled()) {
+                RunSystem(world, node->system, deltaTime);
+            }
+        }
+        return;
+    }
+    
+    for (const auto& node : m_Nodes) {
+        node->remainingDependencies.store(static_cast<uint32_t>(node->dependencies.size()),
+                                          std::memory_order_relaxed);
+    }
+    
+    JobCounter counter;
+    std::function<void(size_t)> runNode = [&](size_t index) {
+        Node& node = *m_Nodes[index];
+        if (node.system->IsEnabled()) {
+            RunSystem(world, node.system, deltaTime);
+        }
+        
+        for (size_t dependent : node.dependents) {
+            if (m_Nodes[dependent]->remainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                jobSystem->Schedule([&runNode, dependent]() { runNode(dependent); }, &counter);
+            }
+        }
+    };
+    
+    for (size_t root : m_Roots) {
+        jobSystem->Schedule([&runNode, root]() { runNode(root); }, &counter);
+    }
+    jobSystem->Wait(counter);
+}
+
+std::string SystemScheduler::DumpSchedule() const {
+    std::ostringstream out;
+    out << "System schedule: " << m_Nodes.size() << " systems, " << m_StageCount << " stages\n";
+    
+    for (size_t stage = 0; stage < m_StageCount; ++stage) {
+        out << "Stage " << stage << ":\n";
+        for (const auto& node : m_Nodes) {
+            if (node->stage != stage) continue;
+            
+            out << "  " << node->system->GetName();
+            if (node->system->GetAccess().exclusive) {
+                out << " [exclusive]";
+            }
+            if (!node->dependencies.empty()) {
+                out << " after";
+                for (size_t dependency : node->dependencies) {
+                    out << " " << m_Nodes[dependency]->system->GetName();
+                }
+            }
+            out << "\n";
+        }
+    }
+    
+    return out.str();
+}
+
+}
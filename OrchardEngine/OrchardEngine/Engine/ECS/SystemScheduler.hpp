@@ -0,0 +1,41 @@
+#pragma once
+
+#include "System.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Orchard {
+class JobSystem;
+}
+
+namespace Orchard::ECS {
+
+class SystemScheduler {
+public:
+    void Build(const std::vector<std::unique_ptr<System>>& systems);
+    void Run(World* world, double deltaTime, JobSystem* jobSystem);
+    
+    std::string DumpSchedule() const;
+    
+    size_t GetStageCount() const { return m_StageCount; }
+    
+private:
+    struct Node {
+        System* system = nullptr;
+        std::vector<size_t> dependencies;
+        std::vector<size_t> dependents;
+        size_t stage = 0;
+        std::atomic<uint32_t> remainingDependencies{0};
+    };
+    
+    static bool Conflicts(const SystemAccess& a, const SystemAccess& b);
+    static void RunSystem(World* world, System* system, double deltaTime);
+    
+    std::vector<std::unique_ptr<Node>> m_Nodes;
+    std::vector<size_t> m_Roots;
+    size_t m_StageCount = 0;
+};
+
+}
@@ -0,0 +1,216 @@
+#include "TransformHierarchySystem.hpp"
+#include "../World.hpp"
+#include "../../Core/JobSystem.hpp"
+#include <algorithm>
+#include <iostream>
+#include <unordered_set>
+
+namespace Orchard::ECS {
+
+Entity GetParent(const World& world, Entity entity) {
+    const Parent* parent = world.GetComponent<Parent>(entity);
+    return parent ? parent->entity : Entity();
+}
+
+uint32_t GetHierarchyDepth(const World& world, Entity entity) {
+    const HierarchyDepth* depth = world.GetSharedComponent<HierarchyDepth>(entity);
+    return depth ? depth->depth : 0;
+}
+
+void SetParent(World& world, Entity child, Entity parent) {
+    if (!world.IsEntityValid(child)) return;
+    
+    if (world.IsEntityValid(parent)) {
+        for (Entity ancestor = parent; ancestor.IsValid(); ancestor = GetParent(world, ancestor)) {
+            if (ancestor == child) {
+                std::cerr << "SetParent: entity " << child.id << " cannot be parented to its own descendant" << std::endl;
+                return;
+            }
+        }
+        
+        world.AddComponent(child, Parent{ parent });
+        world.SetSharedComponent(child, HierarchyDepth{ {}, GetHierarchyDepth(world, parent) + 1 });
+    } else {
+        world.RemoveComponent<Parent>(child);
+        world.RemoveComponent<HierarchyDepth>(child);
+    }
+    
+    world.AddComponent(child, HierarchyDirty{});
+}
+
+TransformHierarchySystem::TransformHierarchySystem() {
+    Reads<TransformComponent>();
+    Reads<Parent>();
+    Reads<HierarchyDepth>();
+    Reads<HierarchyDirty>();
+    Writes<LocalToWorld>();
+}
+
+void TransformHierarchySystem::ResolveDepths(World* world) {
+    m_Resolved.clear();
+    
+    std::vector<std::pair<uint32_t, Entity>> roots;
+    world->ForEach<const HierarchyDirty>([&](Entity entity, const HierarchyDirty&) {
+        uint32_t depth = 0;
+        for (Entity ancestor = GetParent(*world, entity); ancestor.IsValid(); ancestor = GetParent(*world, ancestor)) {
+            ++depth;
+        }
+        roots.emplace_back(depth, entity);
+    });
+    if (roots.empty()) return;
+    
+    std::sort(roots.begin(), roots.end(),
+        [](const std::pair<uint32_t, Entity>& a, const std::pair<uint32_t, Entity>& b) {
+            return a.first < b.first;
+        });
+    
+    m_Children.clear();
+    world->ForEach<const Parent>([this](Entity entity, const Parent& link) {
+        m_Children[link.entity.id].push_back(entity);
+    });
+    
+    EntityCommandBuffer& commands = world->GetCommandBuffer();
+    std::unordered_set<EntityID> visited;
+    std::vector<std::pair<Entity, uint32_t>> stack;
+    for (const auto& [rootDepth, root] : roots) {
+        commands.RemoveComponent<HierarchyDirty>(root);
+        if (!visited.insert(root.id).second) continue;
+        
+        stack.emplace_back(root, rootDepth);
+        while (!stack.empty()) {
+            auto [entity, depth] = stack.back();
+            stack.pop_back();
+            
+            if (GetHierarchyDepth(*world, entity) != depth) {
+                commands.AddComponent(entity, HierarchyDepth{ {}, depth });
+            }
+            m_Resolved.push_back(entity);
+            
+            auto it = m_Children.find(entity.id);
+            if (it == m_Children.end()) continue;
+            
+            for (Entity child : it->second) {
+                visited.insert(child.id);
+                stack.emplace_back(child, depth + 1);
+            }
+        }
+    }
+}
+
+void TransformHierarchySystem::UpdateResolved(World* world) {
+    const World& view = *world;
+    for (Entity entity : m_Resolved) {
+        const TransformComponent* transform = view.GetComponent<TransformComponent>(entity);
+        if (!transform || !view.HasComponent<LocalToWorld>(entity)) continue;
+        
+        const LocalToWorld* parentMatrix = view.GetComponent<LocalToWorld>(GetParent(view, entity));
+        ComputeMatrix(transform->transform, parentMatrix, *world->GetComponent<LocalToWorld>(entity));
+    }
+}
+
+void TransformHierarchySystem::ComputeMatrix(const Math::Transform& local, const LocalToWorld* parentMatrix,
+                                             LocalToWorld& result) {
+    Math::Matrix4 localMatrix = Math::Matrix4::TRS(local.GetPosition(), local.GetRotation(), local.GetScale());
+    if (parentMatrix) {
+        Math::Matrix4::Multiply(parentMatrix->matrix, localMatrix, result.matrix);
+    } else {
+        result.matrix = localMatrix;
+    }
+}
+
+void TransformHierarchySystem::RefreshLevels(World* world) {
+    const auto& archetypes = world->GetArchetypes();
+    ComponentTypeID transformID = ComponentRegistry::GetTypeID<TransformComponent>();
+    ComponentTypeID matrixID = ComponentRegistry::GetTypeID<LocalToWorld>();
+    
+    if (m_ArchetypeGeneration != world->GetArchetypeGeneration()) {
+        m_ArchetypeGeneration = world->GetArchetypeGeneration();
+        m_ArchetypeCursor = 0;
+        m_Levels.clear();
+    }
+    
+    for (; m_ArchetypeCursor < archetypes.size(); ++m_ArchetypeCursor) {
+        Archetype* archetype = archetypes[m_ArchetypeCursor];
+        if (!archetype->HasComponent(transformID) || !archetype->HasComponent(matrixID)) continue;
+        
+        const HierarchyDepth* depth = archetype->GetSharedComponent<HierarchyDepth>();
+        size_t level = depth ? depth->depth : 0;
+        if (level >= m_Levels.size()) {
+            m_Levels.resize(level + 1);
+        }
+        m_Levels[level].push_back(archetype);
+    }
+}
+
+void TransformHierarchySystem::OnUpdate(World* world, double /*deltaTime*/) {
+    ResolveDepths(world);
+    RefreshLevels(world);
+    
+    uint32_t sinceVersion = GetLastRunVersion();
+    uint32_t runVersion = GetRunVersion();
+    JobSystem* jobSystem = world->GetJobSystem();
+    const World& view = *world;
+    
+    for (const auto& level : m_Levels) {
+        m_Work.clear();
+        for (Archetype* archetype : level) {
+            for (size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+                Archetype::Chunk& chunk = archetype->GetChunk(c);
+                if (chunk.entityCount > 0) {
+                    m_Work.push_back(ChunkWork{ archetype, &chunk });
+                }
+            }
+        }
+        
+        auto process = [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                UpdateChunk(view, m_Work[i].archetype, *m_Work[i].chunk, sinceVersion, runVersion);
+            }
+        };
+        
+        if (jobSystem) {
+            size_t grainSize = std::max<size_t>(1, m_Work.size() / (jobSystem->GetThreadCount() * 4));
+            jobSystem->ParallelFor(m_Work.size(), grainSize, process);
+        } else {
+            process(0, m_Work.size());
+        }
+    }
+    
+    UpdateResolved(world);
+}
+
+void TransformHierarchySystem::UpdateChunk(const World& world, Archetype* archetype, Archetype::Chunk& chunk,
+                                           uint32_t sinceVersion, uint32_t runVersion) {
+    size_t transformColumn = archetype->GetComponentIndex(ComponentRegistry::GetTypeID<TransformComponent>());
+    size_t matrixColumn = archetype->GetComponentIndex(ComponentRegistry::GetTypeID<LocalToWorld>());
+    size_t parentColumn = archetype->GetComponentIndex(ComponentRegistry::GetTypeID<Parent>());
+    bool hasParent = parentColumn != Archetype::INVALID_COLUMN && archetype->GetSharedComponent<HierarchyDepth>();
+    
+    bool localChanged = archetype->HasColumnChanged(chunk, transformColumn, sinceVersion) ||
+                        (hasParent && archetype->HasColumnChanged(chunk, parentColumn, sinceVersion));
+    
+    const auto* transforms = static_cast<const TransformComponent*>(archetype->GetColumn(chunk, transformColumn));
+    auto* matrices = static_cast<LocalToWorld*>(archetype->GetColumn(chunk, matrixColumn));
+    const auto* parents = hasParent ? static_cast<const Parent*>(archetype->GetColumn(chunk, parentColumn)) : nullptr;
+    
+    bool written = false;
+    for (size_t i = 0; i < chunk.entityCount; ++i) {
+        const LocalToWorld* parentMatrix = nullptr;
+        if (parents) {
+            bool parentChanged = world.HasChanged<LocalToWorld>(parents[i].entity, runVersion - 1);
+            if (!localChanged && !parentChanged) continue;
+            parentMatrix = world.GetComponent<LocalToWorld>(parents[i].entity);
+        } else if (!localChanged) {
+            break;
+        }
+        
+        ComputeMatrix(transforms[i].transform, parentMatrix, matrices[i]);
+        written = true;
+    }
+    
+    if (written) {
+        archetype->MarkColumnChanged(chunk, matrixColumn, runVersion);
+    }
+}
+
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "../System.hpp"
+#include "../Archetype.hpp"
+#include "../Components/TransformComponent.hpp"
+#include <unordered_map>
+#include <vector>
+
+namespace Orchard::ECS {
+
+void SetParent(World& world, Entity child, Entity parent);
+Entity GetParent(const World& world, Entity entity);
+uint32_t GetHierarchyDepth(const World& world, Entity entity);
+
+class TransformHierarchySystem : public System {
+public:
+    TransformHierarchySystem();
+    
+    void OnUpdate(World* world, double deltaTime) override;
+    
+    const char* GetName() const override { return "TransformHierarchySystem"; }
+    
+    size_t GetLevelCount() const { return m_Levels.size(); }
+    
+private:
+    struct ChunkWork {
+        Archetype* archetype;
+        Archetype::Chunk* chunk;
+    };
+    
+    void RefreshLevels(World* world);
+    void ResolveDepths(World* world);
+    void UpdateResolved(World* world);
+    void UpdateChunk(const World& world, Archetype* archetype, Archetype::Chunk& chunk,
+                     uint32_t sinceVersion, uint32_t runVersion);
+    
+    static void ComputeMatrix(const Math::Transform& local, const LocalToWorld* parentMatrix, LocalToWorld& result);
+    
+    std::vector<std::vector<Archetype*>> m_Levels;
+    std::vector<ChunkWork> m_Work;
+    std::unordered_map<EntityID, std::vector<Entity>> m_Children;
+    std::vector<Entity> m_Resolved;
+    size_t m_ArchetypeCursor = 0;
+    uint64_t m_ArchetypeGeneration = 0;
+};
+
+}
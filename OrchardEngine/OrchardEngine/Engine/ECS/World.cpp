@@ -1,10 +1,20 @@
 #include "World.hpp"
+#include "Components/TransformComponent.hpp"
 #include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace Orchard::ECS {
 
 World::World() {
     m_EntityRecords.reserve(1000);
+    m_InstanceID = s_NextInstanceID.fetch_add(1, std::memory_order_relaxed);
 }
 
 World::~World() {
@@ -37,8 +47,12 @@ void World::DestroyEntity(Entity entity) {
     EntityRecord& record = m_EntityRecords[entity.id];
     
     if (record.archetype) {
-        record.archetype->RemoveEntity(record.indexInArchetype);
+        Entity moved = record.archetype->RemoveEntity(record.indexInArchetype);
+        if (moved.IsValid()) {
+            m_EntityRecords[moved.id].indexInArchetype = record.indexInArchetype;
+        }
     }
+    m_SparseSets.RemoveEntity(entity.id);
     
     record.alive = false;
     record.archetype = nullptr;
@@ -46,68 +60,723 @@ void World::DestroyEntity(Entity entity) {
     m_FreeEntities.push_back(entity.id);
 }
 
+std::vector<Entity> World::CreateEntities(size_t count, const std::vector<ComponentTypeID>& signature,
+                                          const std::vector<const void*>& initialValues, size_t valueCount) {
+    assert(valueCount > 0 && "CreateEntities needs at least one value per initialized column");
+    for (size_t i = 0; i < signature.size(); ++i) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(signature[i]);
+        const void* value = i < initialValues.size() ? initialValues[i] : nullptr;
+        if (value && typeInfo.shared && valueCount != 1) {
+            throw std::invalid_argument(std::string("World::CreateEntities: shared component ") + typeInfo.name +
+                                        " takes a single value");
+        }
+        bool constructible = value ? typeInfo.trivial || typeInfo.copyConstruct
+                                   : !typeInfo.shared && (typeInfo.trivial || typeInfo.defaultConstruct);
+        if (!constructible) {
+            throw std::invalid_argument(std::string("World::CreateEntities: cannot initialize ") + typeInfo.name +
+                                        (value ? " from a copy" : " without an initial value"));
+        }
+    }
+    
+    std::vector<Entity> entities(count);
+    if (count == 0) return entities;
+    
+    ReserveEntities(entities.data(), count);
+    if (signature.empty()) return entities;
+    
+    std::vector<ComponentInfo> components;
+    for (size_t i = 0; i < signature.size(); ++i) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(signature[i]);
+        if (typeInfo.sparse) {
+            const void* value = i < initialValues.size() ? initialValues[i] : nullptr;
+            SparseSet& set = m_SparseSets.GetOrCreate(signature[i]);
+            for (size_t e = 0; e < count; ++e) {
+                if (set.Contains(entities[e].id)) continue;
+                
+                void* slot = set.Emplace(entities[e]);
+                if (value) {
+                    typeInfo.copyConstruct(slot, static_cast<const uint8_t*>(value) + (e % valueCount) * typeInfo.valueSize);
+                } else if (!typeInfo.trivialValue) {
+                    typeInfo.defaultConstruct(slot);
+                } else {
+                    std::memset(slot, 0, typeInfo.valueSize);
+                }
+            }
+            continue;
+        }
+        
+        auto it = std::find_if(components.begin(), components.end(),
+            [&](const ComponentInfo& info) {
+                return info.typeID == signature[i];
+            });
+        if (it != components.end()) continue;
+        
+        uint32_t sharedIndex = INVALID_SHARED_INDEX;
+        if (typeInfo.shared) {
+            sharedIndex = m_SharedComponents.Intern(signature[i], initialValues[i]);
+        }
+        components.push_back(ComponentInfo(signature[i], 0, 0, sharedIndex));
+    }
+    
+    if (components.empty()) return entities;
+    
+    Archetype* archetype = GetOrCreateArchetype(components);
+    
+    std::vector<const void*> columnValues(archetype->GetComponentTypes().size(), nullptr);
+    for (size_t i = 0; i < signature.size() && i < initialValues.size(); ++i) {
+        if (ComponentRegistry::GetTypeInfo(signature[i]).sparse) continue;
+        columnValues[archetype->GetComponentIndex(signature[i])] = initialValues[i];
+    }
+    
+    std::vector<size_t> indices(count);
+    archetype->AddEntities(entities.data(), count, columnValues.data(), indices.data(), valueCount);
+    
+    for (size_t i = 0; i < count; ++i) {
+        EntityRecord& record = m_EntityRecords[entities[i].id];
+        record.archetype = archetype;
+        record.indexInArchetype = indices[i];
+    }
+    
+    return entities;
+}
+
+void World::DestroyEntities(const std::vector<Entity>& entities) {
+    struct Removal {
+        Archetype* archetype;
+        size_t index;
+    };
+    
+    std::vector<Removal> removals;
+    removals.reserve(entities.size());
+    for (Entity entity : entities) {
+        if (!IsEntityValid(entity)) continue;
+        
+        EntityRecord& record = m_EntityRecords[entity.id];
+        if (record.archetype) {
+            removals.push_back(Removal{ record.archetype, record.indexInArchetype });
+        }
+        
+        record.alive = false;
+        record.archetype = nullptr;
+        m_SparseSets.RemoveEntity(entity.id);
+        m_FreeEntities.push_back(entity.id);
+    }
+    
+    std::sort(removals.begin(), removals.end(),
+        [](const Removal& a, const Removal& b) {
+            if (a.archetype != b.archetype) return a.archetype < b.archetype;
+            return a.index > b.index;
+        });
+    
+    for (const Removal& removal : removals) {
+        Entity moved = removal.archetype->RemoveEntity(removal.index);
+        if (moved.IsValid()) {
+            m_EntityRecords[moved.id].indexInArchetype = removal.index;
+        }
+    }
+}
+
+PrefabID World::CreatePrefab(const std::vector<Entity>& entities) {
+    auto prefab = std::make_unique<Prefab>(entities.size());
+    
+    std::unordered_map<EntityID, uint32_t> memberIndices;
+    for (size_t m = 0; m < entities.size(); ++m) {
+        assert(IsEntityValid(entities[m]) && "Prefab members must be alive");
+        memberIndices.emplace(entities[m].id, static_cast<uint32_t>(m));
+        
+        if (Archetype* archetype = m_EntityRecords[entities[m].id].archetype) {
+            prefab->GetGroup(archetype).members.push_back(static_cast<uint32_t>(m));
+        }
+    }
+    
+    ComponentTypeID parentType = ComponentRegistry::GetTypeID<Parent>();
+    for (Prefab::Group& group : prefab->GetGroups()) {
+        const Archetype* archetype = group.archetype;
+        const auto& components = archetype->GetComponentTypes();
+        
+        for (size_t c = 0; c < components.size(); ++c) {
+            const ComponentInfo& info = components[c];
+            if (info.size == 0) continue;
+            
+            const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(info.typeID);
+            assert((typeInfo.trivial || typeInfo.copyConstruct) && "Prefab components must be copyable");
+            
+            uint8_t* rows = static_cast<uint8_t*>(::operator new(group.members.size() * info.size, std::align_val_t(info.alignment)));
+            for (size_t r = 0; r < group.members.size(); ++r) {
+                const EntityRecord& record = m_EntityRecords[entities[group.members[r]].id];
+                const void* value = archetype->GetComponent(record.indexInArchetype, info.typeID);
+                if (typeInfo.trivial) {
+                    std::memcpy(rows + r * info.size, value, info.size);
+                } else {
+                    typeInfo.copyConstruct(rows + r * info.size, value);
+                }
+            }
+            group.columns[c] = rows;
+        }
+        
+        if (archetype->HasComponent(parentType)) {
+            for (uint32_t member : group.members) {
+                const EntityRecord& record = m_EntityRecords[entities[member].id];
+                const Parent* parent = archetype->GetComponent<Parent>(record.indexInArchetype);
+                auto it = memberIndices.find(parent->entity.id);
+                group.parentMembers.push_back(it != memberIndices.end() ? it->second : Prefab::NO_MEMBER);
+            }
+        }
+    }
+    
+    m_Prefabs.push_back(std::move(prefab));
+    return static_cast<PrefabID>(m_Prefabs.size() - 1);
+}
+
+std::vector<Entity> World::InstantiatePrefab(PrefabID id, size_t count) {
+    assert(id < m_Prefabs.size() && m_Prefabs[id] && "Invalid prefab");
+    const Prefab& prefab = *m_Prefabs[id];
+    size_t memberCount = prefab.GetMemberCount();
+    
+    std::vector<Entity> entities(count * memberCount);
+    if (entities.empty()) return entities;
+    
+    ReserveEntities(entities.data(), entities.size());
+    
+    std::vector<Entity> groupEntities;
+    std::vector<size_t> indices;
+    for (const Prefab::Group& group : prefab.GetGroups()) {
+        size_t rows = group.members.size();
+        size_t total = count * rows;
+        
+        groupEntities.resize(total);
+        indices.resize(total);
+        for (size_t instance = 0; instance < count; ++instance) {
+            for (size_t r = 0; r < rows; ++r) {
+                groupEntities[instance * rows + r] = entities[instance * memberCount + group.members[r]];
+            }
+        }
+        
+        Archetype* archetype = group.archetype;
+        archetype->AddEntities(groupEntities.data(), total, group.columns.data(), indices.data(), rows);
+        
+        for (size_t i = 0; i < total; ++i) {
+            EntityRecord& record = m_EntityRecords[groupEntities[i].id];
+            record.archetype = archetype;
+            record.indexInArchetype = indices[i];
+        }
+        
+        if (group.parentMembers.empty()) continue;
+        
+        for (size_t i = 0; i < total; ++i) {
+            uint32_t target = group.parentMembers[i % rows];
+            if (target != Prefab::NO_MEMBER) {
+                archetype->GetComponent<Parent>(indices[i])->entity = entities[(i / rows) * memberCount + target];
+            }
+        }
+    }
+    
+    return entities;
+}
+
+void World::DestroyPrefab(PrefabID id) {
+    if (id < m_Prefabs.size()) {
+        m_Prefabs[id].reset();
+    }
+}
+
+void World::ReserveEntities(Entity* entities, size_t count) {
+    size_t reused = std::min(count, m_FreeEntities.size());
+    for (size_t i = 0; i < reused; ++i) {
+        entities[i] = Entity(m_FreeEntities.back(), 0);
+        m_FreeEntities.pop_back();
+    }
+    
+    EntityID first = m_NextEntityID;
+    m_NextEntityID += count - reused;
+    if (m_NextEntityID > m_EntityRecords.size()) {
+        m_EntityRecords.resize(m_NextEntityID);
+    }
+    
+    for (size_t i = reused; i < count; ++i) {
+        entities[i] = Entity(first + (i - reused), 0);
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        EntityRecord& record = m_EntityRecords[entities[i].id];
+        record.alive = true;
+        record.archetype = nullptr;
+        record.indexInArchetype = 0;
+    }
+}
+
 bool World::IsEntityValid(Entity entity) const {
     if (entity.id >= m_EntityRecords.size()) return false;
     return m_EntityRecords[entity.id].alive;
 }
 
-void World::RemoveComponent(Entity entity) {
-}
-
 void World::AddSystem(std::unique_ptr<System> system) {
     system->OnInit(this);
     m_Systems.push_back(std::move(system));
+    m_ScheduleDirty = true;
 }
 
 void World::Update(double deltaTime) {
-    for (auto& system : m_Systems) {
-        system->OnUpdate(this, deltaTime);
+    if (m_ScheduleDirty) {
+        m_Scheduler.Build(m_Systems);
+        m_ScheduleDirty = false;
+    }
+    
+    m_Scheduler.Run(this, deltaTime, m_JobSystem);
+    PlaybackCommands();
+    
+    if (m_CompactionBudget > 0.0) {
+        Compact(m_CompactionBudget);
     }
 }
 
-Archetype* World::GetOrCreateArchetype(const std::vector<ComponentTypeID>& componentTypes) {
-    uint64_t hash = GetArchetypeHash(componentTypes);
+std::shared_ptr<const WorldSnapshot> World::CaptureSnapshot() {
+    std::shared_ptr<const WorldSnapshot> snapshot = WorldSnapshot::Capture(*this, m_LatestSnapshot.get());
+    std::atomic_store(&m_LatestSnapshot, snapshot);
+    return snapshot;
+}
+
+bool World::Compact(double budgetMilliseconds) {
+    constexpr size_t COMPACT_BATCH_SIZE = 256;
     
-    auto it = m_Archetypes.find(hash);
-    if (it != m_Archetypes.end()) {
-        return it->second.get();
+    auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double, std::milli>(budgetMilliseconds));
+    
+    auto fixup = [this](Entity entity, size_t index) {
+        m_EntityRecords[entity.id].indexInArchetype = index;
+    };
+    
+    for (size_t visited = 0; visited < m_ArchetypeList.size(); ++visited) {
+        if (m_CompactCursor >= m_ArchetypeList.size()) {
+            m_CompactCursor = 0;
+        }
+        
+        Archetype* archetype = m_ArchetypeList[m_CompactCursor];
+        while (archetype->NeedsCompaction()) {
+            if (archetype->Compact(COMPACT_BATCH_SIZE, fixup) == 0) break;
+            if (std::chrono::steady_clock::now() >= deadline) return false;
+        }
+        
+        ++m_CompactCursor;
+    }
+    
+    RetireEmptyArchetypes();
+    m_ChunkPool->Trim();
+    return true;
+}
+
+EntityCommandBuffer& World::GetCommandBuffer() {
+    thread_local uint64_t t_WorldID = 0;
+    thread_local EntityCommandBuffer* t_Buffer = nullptr;
+    
+    if (t_WorldID == m_InstanceID) {
+        return *t_Buffer;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_CommandBufferMutex);
+    EntityCommandBuffer*& buffer = m_ThreadCommandBuffers[std::this_thread::get_id()];
+    if (!buffer) {
+        m_CommandBuffers.push_back(std::make_unique<EntityCommandBuffer>(static_cast<uint32_t>(m_CommandBuffers.size())));
+        buffer = m_CommandBuffers.back().get();
     }
     
+    t_WorldID = m_InstanceID;
+    t_Buffer = buffer;
+    return *buffer;
+}
+
+void World::PlaybackCommands() {
+    using CommandType = EntityCommandBuffer::CommandType;
+    
+    struct ResolvedCommand {
+        Entity entity;
+        const EntityCommandBuffer::Command* command;
+    };
+    
+    auto destroyPayload = [](const EntityCommandBuffer::Command& command) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(command.typeID);
+        if (!typeInfo.trivialValue) {
+            typeInfo.destroy(command.data);
+        }
+    };
+    
+    std::vector<std::vector<Entity>> createdEntities(m_CommandBuffers.size());
+    for (const auto& buffer : m_CommandBuffers) {
+        std::vector<Entity>& created = createdEntities[buffer->GetBufferIndex()];
+        for (const auto& command : buffer->GetCommands()) {
+            if (command.type == CommandType::CreateEntity) {
+                created.push_back(CreateEntity());
+            }
+        }
+    }
+    
+    std::vector<ResolvedCommand> commands;
+    for (const auto& buffer : m_CommandBuffers) {
+        for (const auto& command : buffer->GetCommands()) {
+            if (command.type == CommandType::CreateEntity) continue;
+            
+            Entity entity = command.entity;
+            if (EntityCommandBuffer::IsDeferred(entity)) {
+                uint32_t source = EntityCommandBuffer::GetDeferredBuffer(entity);
+                size_t index = EntityCommandBuffer::GetDeferredIndex(entity);
+                if (source >= createdEntities.size() || index >= createdEntities[source].size()) {
+                    assert(false && "Deferred entity does not belong to any command buffer of this world");
+                    if (command.type == CommandType::AddComponent) {
+                        destroyPayload(command);
+                    }
+                    continue;
+                }
+                entity = createdEntities[source][index];
+            }
+            commands.push_back(ResolvedCommand{ entity, &command });
+        }
+    }
+    
+    std::stable_sort(commands.begin(), commands.end(),
+        [](const ResolvedCommand& a, const ResolvedCommand& b) {
+            return a.entity.id < b.entity.id;
+        });
+    
+    struct PendingMove {
+        Entity entity;
+        Archetype* target;
+        size_t begin;
+        size_t end;
+        size_t batch;
+    };
+    
+    std::vector<PendingMove> moves;
+    std::unordered_map<Archetype*, size_t> batches;
+    for (size_t begin = 0; begin < commands.size();) {
+        Entity entity = commands[begin].entity;
+        size_t end = begin;
+        bool destroyed = !IsEntityValid(entity);
+        while (end < commands.size() && commands[end].entity.id == entity.id) {
+            destroyed |= commands[end].command->type == CommandType::DestroyEntity;
+            ++end;
+        }
+        
+        if (destroyed) {
+            for (size_t i = begin; i < end; ++i) {
+                if (commands[i].command->type == CommandType::AddComponent) {
+                    destroyPayload(*commands[i].command);
+                }
+            }
+            DestroyEntity(entity);
+            begin = end;
+            continue;
+        }
+        
+        Archetype* archetype = m_EntityRecords[entity.id].archetype;
+        for (size_t i = begin; i < end; ++i) {
+            const auto& command = *commands[i].command;
+            const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(command.typeID);
+            if (typeInfo.sparse) continue;
+            
+            bool present = archetype && archetype->HasComponent(command.typeID);
+            if (command.type == CommandType::AddComponent && typeInfo.shared) {
+                archetype = GetSharedTarget(archetype, command.typeID, m_SharedComponents.Intern(command.typeID, command.data));
+            } else if (command.type == CommandType::AddComponent && !present) {
+                archetype = GetAddEdge(archetype, command.typeID).archetype;
+            } else if (command.type == CommandType::RemoveComponent && present) {
+                archetype = GetRemoveEdge(archetype, command.typeID).archetype;
+            }
+        }
+        
+        size_t batch = batches.emplace(archetype, batches.size()).first->second;
+        moves.push_back(PendingMove{ entity, archetype, begin, end, batch });
+        begin = end;
+    }
+    
+    std::stable_sort(moves.begin(), moves.end(),
+        [](const PendingMove& a, const PendingMove& b) {
+            return a.batch < b.batch;
+        });
+    
+    std::map<std::pair<Archetype*, Archetype*>, ArchetypeEdge> edges;
+    std::vector<ComponentTypeID> constructed;
+    for (const PendingMove& move : moves) {
+        EntityRecord& record = m_EntityRecords[move.entity.id];
+        Archetype* source = record.archetype;
+        
+        constructed.clear();
+        if (source && move.target) {
+            for (const auto& info : source->GetComponentTypes()) {
+                if (move.target->HasComponent(info.typeID)) {
+                    constructed.push_back(info.typeID);
+                }
+            }
+        }
+        
+        if (source != move.target) {
+            auto key = std::make_pair(source, move.target);
+            auto it = edges.find(key);
+            if (it == edges.end()) {
+                it = edges.emplace(key, Archetype::BuildEdge(source, move.target)).first;
+            }
+            MoveEntity(move.entity, it->second);
+        }
+        
+        for (size_t i = move.begin; i < move.end; ++i) {
+            const auto& command = *commands[i].command;
+            if (command.type != CommandType::AddComponent && command.type != CommandType::RemoveComponent) continue;
+            
+            const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(command.typeID);
+            if (typeInfo.sparse) {
+                PlaybackSparseCommand(move.entity, command);
+                continue;
+            }
+            if (command.type != CommandType::AddComponent) continue;
+            
+            if (!move.target || !move.target->HasComponent(command.typeID) || typeInfo.shared) {
+                destroyPayload(command);
+                continue;
+            }
+            
+            void* slot = move.target->GetComponent(record.indexInArchetype, command.typeID);
+            
+            bool initialized = std::find(constructed.begin(), constructed.end(), command.typeID) != constructed.end();
+            if (initialized && !typeInfo.trivial) {
+                typeInfo.destroy(slot);
+            }
+            
+            if (typeInfo.trivial) {
+                std::memcpy(slot, command.data, typeInfo.size);
+            } else {
+                typeInfo.moveConstruct(slot, command.data);
+                typeInfo.destroy(command.data);
+            }
+            
+            if (!initialized) {
+                constructed.push_back(command.typeID);
+            }
+        }
+    }
+    
+    for (const auto& buffer : m_CommandBuffers) {
+        buffer->Reset();
+    }
+}
+
+void World::PlaybackSparseCommand(Entity entity, const EntityCommandBuffer::Command& command) {
+    const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(command.typeID);
+    
+    if (command.type == EntityCommandBuffer::CommandType::RemoveComponent) {
+        if (SparseSet* set = m_SparseSets.Find(command.typeID)) {
+            set->Remove(entity.id);
+        }
+        return;
+    }
+    
+    SparseSet& set = m_SparseSets.GetOrCreate(command.typeID);
+    void* slot = set.Get(entity.id);
+    if (slot) {
+        typeInfo.destroy(slot);
+    } else {
+        slot = set.Emplace(entity);
+    }
+    
+    typeInfo.moveConstruct(slot, command.data);
+    typeInfo.destroy(command.data);
+}
+
+std::string World::DumpSchedule() {
+    if (m_ScheduleDirty) {
+        m_Scheduler.Build(m_Systems);
+        m_ScheduleDirty = false;
+    }
+    
+    return m_Scheduler.DumpSchedule();
+}
+
+Archetype* World::GetOrCreateArchetype(const std::vector<ComponentInfo>& components) {
     std::vector<ComponentInfo> infos;
-    for (ComponentTypeID typeID : componentTypes) {
-        infos.push_back(ComponentInfo(typeID, 0, 16));
+    for (const ComponentInfo& component : components) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(component.typeID);
+        infos.push_back(ComponentInfo(component.typeID, typeInfo.size, typeInfo.alignment,
+                                      typeInfo.shared ? component.sharedIndex : INVALID_SHARED_INDEX));
     }
     
-    auto archetype = std::make_unique<Archetype>(infos);
+    std::sort(infos.begin(), infos.end(),
+        [](const ComponentInfo& a, const ComponentInfo& b) {
+            return a.stableID < b.stableID;
+        });
+    
+    uint64_t hash = GetArchetypeHash(infos);
+    
+    auto it = m_Archetypes.find(hash);
+    if (it != m_Archetypes.end()) {
+        if (it->second->IsRetired()) {
+            AcquireSharedValues(it->second.get());
+            ++m_ArchetypeGeneration;
+        }
+        return it->second.get();
+    }
+    
+    auto archetype = std::make_unique<Archetype>(infos, *m_ChunkPool, m_ChangeVersion);
     Archetype* ptr = archetype.get();
     m_Archetypes[hash] = std::move(archetype);
+    m_ArchetypeList.push_back(ptr);
+    AcquireSharedValues(ptr);
     
     return ptr;
 }
 
-uint64_t World::GetArchetypeHash(const std::vector<ComponentTypeID>& componentTypes) {
-    std::vector<ComponentTypeID> sorted = componentTypes;
-    std::sort(sorted.begin(), sorted.end());
+void World::AcquireSharedValues(Archetype* archetype) {
+    const std::vector<ComponentInfo>& components = archetype->GetComponentTypes();
+    for (size_t i = 0; i < components.size(); ++i) {
+        if (components[i].sharedIndex != INVALID_SHARED_INDEX) {
+            archetype->SetSharedValue(i, m_SharedComponents.Acquire(components[i].typeID, components[i].sharedIndex));
+        }
+    }
+}
+
+void World::RetireEmptyArchetypes() {
+    std::unordered_set<const Archetype*> pinned;
+    for (const auto& prefab : m_Prefabs) {
+        if (!prefab) continue;
+        for (const Prefab::Group& group : prefab->GetGroups()) {
+            pinned.insert(group.archetype);
+        }
+    }
+    
+    bool retired = false;
+    for (Archetype* archetype : m_ArchetypeList) {
+        if (!archetype->HasSharedComponents() || archetype->IsRetired() ||
+            archetype->GetEntityCount() != 0 || pinned.count(archetype)) continue;
+        
+        archetype->ReleaseSharedValues();
+        retired = true;
+    }
+    
+    if (!retired) return;
     
+    for (Archetype* archetype : m_ArchetypeList) {
+        archetype->ForgetRetiredEdges();
+    }
+    m_SharedComponents.ReleaseUnused();
+}
+
+uint64_t World::GetArchetypeHash(const std::vector<ComponentInfo>& components) {
     uint64_t hash = 0;
-    for (ComponentTypeID typeID : sorted) {
-        hash ^= std::hash<ComponentTypeID>{}(typeID) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    for (const ComponentInfo& component : components) {
+        hash ^= component.stableID + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        if (component.sharedIndex != INVALID_SHARED_INDEX) {
+            hash ^= std::hash<uint32_t>{}(component.sharedIndex) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
     }
     
     return hash;
 }
 
-void World::MoveEntity(Entity entity, Archetype* newArchetype) {
+Archetype* World::GetSharedTarget(Archetype* source, ComponentTypeID typeID, uint32_t sharedIndex) {
+    std::vector<ComponentInfo> components;
+    if (source) {
+        components = source->GetComponentTypes();
+    }
+    
+    auto it = std::find_if(components.begin(), components.end(),
+        [typeID](const ComponentInfo& info) {
+            return info.typeID == typeID;
+        });
+    
+    if (it != components.end()) {
+        if (it->sharedIndex == sharedIndex) return source;
+        it->sharedIndex = sharedIndex;
+    } else {
+        components.push_back(ComponentInfo(typeID, 0, 0, sharedIndex));
+    }
+    
+    return GetOrCreateArchetype(components);
+}
+
+void World::SetSharedComponent(Entity entity, ComponentTypeID typeID, const void* value) {
+    if (!IsEntityValid(entity)) return;
+    
+    EntityRecord& record = m_EntityRecords[entity.id];
+    uint32_t sharedIndex = m_SharedComponents.Intern(typeID, value);
+    Archetype* target = GetSharedTarget(record.archetype, typeID, sharedIndex);
+    
+    if (target != record.archetype) {
+        MoveEntity(entity, Archetype::BuildEdge(record.archetype, target));
+    }
+}
+
+const ArchetypeEdge& World::GetAddEdge(Archetype* source, ComponentTypeID typeID) {
+    if (source) {
+        if (const ArchetypeEdge* edge = source->FindAddEdge(typeID)) {
+            return *edge;
+        }
+    } else if (typeID < m_RootEdges.size() && m_RootEdges[typeID].cached) {
+        return m_RootEdges[typeID];
+    }
+    
+    std::vector<ComponentInfo> components;
+    if (source) {
+        components = source->GetComponentTypes();
+    }
+    components.push_back(ComponentInfo(typeID, 0, 0));
+    
+    Archetype* target = GetOrCreateArchetype(components);
+    
+    if (!source) {
+        if (typeID >= m_RootEdges.size()) {
+            m_RootEdges.resize(typeID + 1);
+        }
+        m_RootEdges[typeID] = Archetype::BuildEdge(nullptr, target);
+        return m_RootEdges[typeID];
+    }
+    
+    target->SetRemoveEdge(typeID, source);
+    return source->SetAddEdge(typeID, target);
+}
+
+const ArchetypeEdge& World::GetRemoveEdge(Archetype* source, ComponentTypeID typeID) {
+    if (const ArchetypeEdge* edge = source->FindRemoveEdge(typeID)) {
+        return *edge;
+    }
+    
+    std::vector<ComponentInfo> components;
+    for (const auto& info : source->GetComponentTypes()) {
+        if (info.typeID != typeID) {
+            components.push_back(info);
+        }
+    }
+    
+    Archetype* target = components.empty() ? nullptr : GetOrCreateArchetype(components);
+    if (target && !ComponentRegistry::GetTypeInfo(typeID).shared) {
+        target->SetAddEdge(typeID, source);
+    }
+    return source->SetRemoveEdge(typeID, target);
+}
+
+void World::MoveEntity(Entity entity, const ArchetypeEdge& edge) {
     if (!IsEntityValid(entity)) return;
     
     EntityRecord& record = m_EntityRecords[entity.id];
+    Archetype* newArchetype = edge.archetype;
     
     if (record.archetype == newArchetype) return;
     
-    record.archetype = newArchetype;
+    size_t newIndex = 0;
     if (newArchetype) {
-        record.indexInArchetype = newArchetype->AddEntity(entity);
+        newIndex = newArchetype->AddEntity(entity);
     }
+    
+    if (record.archetype) {
+        if (newArchetype) {
+            record.archetype->MoveEntityTo(record.indexInArchetype, edge, newIndex);
+        }
+        
+        Entity moved = record.archetype->RemoveEntity(record.indexInArchetype);
+        if (moved.IsValid()) {
+            m_EntityRecords[moved.id].indexInArchetype = record.indexInArchetype;
+        }
+    }
+    
+    record.archetype = newArchetype;
+    record.indexInArchetype = newIndex;
 }
 
 }
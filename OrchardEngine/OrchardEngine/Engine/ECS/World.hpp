@@ -3,10 +3,23 @@
 #include "Entity.hpp"
 #include "Component.hpp"
 #include "Archetype.hpp"
+#include "Query.hpp"
+#include "CommandBuffer.hpp"
+#include "Prefab.hpp"
+#include "SharedComponentStore.hpp"
+#include "SparseSet.hpp"
 #include "System.hpp"
+#include "SystemScheduler.hpp"
+#include "WorldSnapshot.hpp"
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <typeindex>
 
 namespace Orchard::ECS {
 
@@ -19,25 +32,77 @@ public:
     void DestroyEntity(Entity entity);
     bool IsEntityValid(Entity entity) const;
     
+    std::vector<Entity> CreateEntities(size_t count, const std::vector<ComponentTypeID>& signature,
+                                       const std::vector<const void*>& initialValues, size_t valueCount = 1);
+    
+    template<typename... Components>
+    std::vector<Entity> CreateEntities(size_t count, const Components&... initialValues);
+    
+    void DestroyEntities(const std::vector<Entity>& entities);
+    
+    PrefabID CreatePrefab(const std::vector<Entity>& entities);
+    std::vector<Entity> InstantiatePrefab(PrefabID prefab, size_t count);
+    void DestroyPrefab(PrefabID prefab);
+    
+    bool Compact(double budgetMilliseconds);
+    void SetCompactionBudget(double budgetMilliseconds) { m_CompactionBudget = budgetMilliseconds; }
+    
     template<typename T>
     void AddComponent(Entity entity, const T& component);
     
     template<typename T>
     void RemoveComponent(Entity entity);
     
+    template<typename T>
+    void SetSharedComponent(Entity entity, const T& value);
+    void SetSharedComponent(Entity entity, ComponentTypeID typeID, const void* value);
+    
+    template<typename T>
+    const T* GetSharedComponent(Entity entity) const;
+    
     template<typename T>
     T* GetComponent(Entity entity);
     
+    template<typename T>
+    const T* GetComponent(Entity entity) const;
+    
     template<typename T>
     bool HasComponent(Entity entity) const;
     
+    template<typename T>
+    bool HasChanged(Entity entity, uint32_t sinceVersion) const;
+    
     template<typename... Components>
-    void ForEach(std::function<void(Entity, Components&...)> callback);
+    Query<Components...>& GetQuery();
+    
+    template<typename... Components, typename Func>
+    void ForEach(Func&& callback);
+    
+    const std::vector<Archetype*>& GetArchetypes() const { return m_ArchetypeList; }
+    uint64_t GetArchetypeGeneration() const { return m_ArchetypeGeneration; }
+    
+    ChunkPool& GetChunkPool() { return *m_ChunkPool; }
+    const std::shared_ptr<ChunkPool>& GetSharedChunkPool() const { return m_ChunkPool; }
+    ChunkPoolStats GetChunkPoolStats() const { return m_ChunkPool->GetStats(); }
+    
+    uint32_t GetChangeVersion() const { return m_ChangeVersion.load(std::memory_order_relaxed); }
+    uint32_t AdvanceChangeVersion() { return m_ChangeVersion.fetch_add(1, std::memory_order_relaxed) + 1; }
+    
+    std::shared_ptr<const WorldSnapshot> CaptureSnapshot();
+    std::shared_ptr<const WorldSnapshot> GetLatestSnapshot() const { return std::atomic_load(&m_LatestSnapshot); }
+    
+    EntityCommandBuffer& GetCommandBuffer();
+    void PlaybackCommands();
     
     void AddSystem(std::unique_ptr<System> system);
     
+    void SetJobSystem(JobSystem* jobSystem) { m_JobSystem = jobSystem; }
+    JobSystem* GetJobSystem() const { return m_JobSystem; }
+    
     void Update(double deltaTime);
     
+    std::string DumpSchedule();
+    
 private:
     struct EntityRecord {
         Archetype* archetype = nullptr;
@@ -48,61 +113,201 @@ private:
     std::vector<EntityRecord> m_EntityRecords;
     std::vector<EntityID> m_FreeEntities;
     EntityID m_NextEntityID = 1;
+    std::atomic<uint32_t> m_ChangeVersion{1};
     
+    std::shared_ptr<ChunkPool> m_ChunkPool = std::make_shared<ChunkPool>();
+    SharedComponentStore m_SharedComponents;
+    SparseSetStorage m_SparseSets;
+    size_t m_CompactCursor = 0;
+    double m_CompactionBudget = 0.0;
     std::unordered_map<uint64_t, std::unique_ptr<Archetype>> m_Archetypes;
+    std::vector<Archetype*> m_ArchetypeList;
+    uint64_t m_ArchetypeGeneration = 0;
+    std::vector<ArchetypeEdge> m_RootEdges;
+    std::vector<std::unique_ptr<Prefab>> m_Prefabs;
+    std::unordered_map<std::type_index, std::unique_ptr<QueryBase>> m_Queries;
+    std::mutex m_QueryMutex;
     std::vector<std::unique_ptr<System>> m_Systems;
+    SystemScheduler m_Scheduler;
+    bool m_ScheduleDirty = true;
+    JobSystem* m_JobSystem = nullptr;
+    
+    std::vector<std::unique_ptr<EntityCommandBuffer>> m_CommandBuffers;
+    std::unordered_map<std::thread::id, EntityCommandBuffer*> m_ThreadCommandBuffers;
+    std::mutex m_CommandBufferMutex;
+    uint64_t m_InstanceID = 0;
+    std::shared_ptr<const WorldSnapshot> m_LatestSnapshot;
+    
+    static inline std::atomic<uint64_t> s_NextInstanceID{1};
+    
+    void ReserveEntities(Entity* entities, size_t count);
+    
+    Archetype* GetOrCreateArchetype(const std::vector<ComponentInfo>& components);
+    uint64_t GetArchetypeHash(const std::vector<ComponentInfo>& components);
+    Archetype* GetSharedTarget(Archetype* source, ComponentTypeID typeID, uint32_t sharedIndex);
+    void AcquireSharedValues(Archetype* archetype);
+    void RetireEmptyArchetypes();
+    
+    const ArchetypeEdge& GetAddEdge(Archetype* source, ComponentTypeID typeID);
+    const ArchetypeEdge& GetRemoveEdge(Archetype* source, ComponentTypeID typeID);
     
-    Archetype* GetOrCreateArchetype(const std::vector<ComponentTypeID>& componentTypes);
-    uint64_t GetArchetypeHash(const std::vector<ComponentTypeID>& componentTypes);
+    void MoveEntity(Entity entity, const ArchetypeEdge& edge);
+    void PlaybackSparseCommand(Entity entity, const EntityCommandBuffer::Command& command);
     
-    void MoveEntity(Entity entity, Archetype* newArchetype);
+    friend class WorldSerializer;
 };
 
+template<typename... Components>
+std::vector<Entity> World::CreateEntities(size_t count, const Components&... initialValues) {
+    return CreateEntities(count,
+        std::vector<ComponentTypeID>{ ComponentRegistry::GetTypeID<Components>()... },
+        std::vector<const void*>{ static_cast<const void*>(&initialValues)... });
+}
+
 template<typename T>
 void World::AddComponent(Entity entity, const T& component) {
+    if constexpr (ComponentTrait<T>::is_shared) {
+        SetSharedComponent(entity, component);
+    } else if constexpr (ComponentTrait<T>::is_sparse) {
+        if (!IsEntityValid(entity)) return;
+        
+        SparseSet& set = m_SparseSets.GetOrCreate(ComponentRegistry::GetTypeID<T>());
+        if (void* existing = set.Get(entity.id)) {
+            *static_cast<T*>(existing) = component;
+        } else {
+            new (set.Emplace(entity)) T(component);
+        }
+    } else {
+        if (!IsEntityValid(entity)) return;
+        
+        EntityRecord& record = m_EntityRecords[entity.id];
+        ComponentTypeID typeID = ComponentRegistry::GetTypeID<T>();
+        
+        if (record.archetype && record.archetype->HasComponent(typeID)) {
+            *record.archetype->GetComponent<T>(record.indexInArchetype) = component;
+            return;
+        }
+        
+        MoveEntity(entity, GetAddEdge(record.archetype, typeID));
+        
+        if constexpr (!ComponentTrait<T>::is_tag) {
+            void* componentPtr = record.archetype->GetComponent(record.indexInArchetype, typeID);
+            new (componentPtr) T(component);
+        }
+    }
+}
+
+template<typename T>
+void World::RemoveComponent(Entity entity) {
     if (!IsEntityValid(entity)) return;
     
-    EntityRecord& record = m_EntityRecords[entity.id];
-    
-    std::vector<ComponentTypeID> newTypes;
-    if (record.archetype) {
-        for (const auto& info : record.archetype->GetComponentTypes()) {
-            newTypes.push_back(info.typeID);
+    ComponentTypeID typeID = ComponentRegistry::GetTypeID<T>();
+    if constexpr (ComponentTrait<T>::is_sparse) {
+        if (SparseSet* set = m_SparseSets.Find(typeID)) {
+            set->Remove(entity.id);
         }
+        return;
     }
-    newTypes.push_back(ComponentRegistry::GetTypeID<T>());
     
-    Archetype* newArchetype = GetOrCreateArchetype(newTypes);
-    MoveEntity(entity, newArchetype);
+    EntityRecord& record = m_EntityRecords[entity.id];
+    if (!record.archetype || !record.archetype->HasComponent(typeID)) return;
     
-    T* componentPtr = record.archetype->GetComponent<T>(record.indexInArchetype);
-    if (componentPtr) {
-        *componentPtr = component;
-    }
+    MoveEntity(entity, GetRemoveEdge(record.archetype, typeID));
+}
+
+template<typename T>
+void World::SetSharedComponent(Entity entity, const T& value) {
+    static_assert(ComponentTrait<T>::is_shared, "SetSharedComponent requires a type derived from SharedComponent");
+    SetSharedComponent(entity, ComponentRegistry::GetTypeID<T>(), &value);
+}
+
+template<typename T>
+const T* World::GetSharedComponent(Entity entity) const {
+    if (!IsEntityValid(entity)) return nullptr;
+    
+    const EntityRecord& record = m_EntityRecords[entity.id];
+    if (!record.archetype) return nullptr;
+    
+    return record.archetype->GetSharedComponent<T>();
 }
 
 template<typename T>
 T* World::GetComponent(Entity entity) {
+    static_assert(!ComponentTrait<T>::is_shared, "Shared components are read-only; use GetSharedComponent");
+    
     if (!IsEntityValid(entity)) return nullptr;
     
+    if constexpr (ComponentTrait<T>::is_sparse) {
+        SparseSet* set = m_SparseSets.Find(ComponentRegistry::GetTypeID<T>());
+        return set ? static_cast<T*>(set->Get(entity.id)) : nullptr;
+    }
+    
     EntityRecord& record = m_EntityRecords[entity.id];
     if (!record.archetype) return nullptr;
     
     return record.archetype->GetComponent<T>(record.indexInArchetype);
 }
 
+template<typename T>
+const T* World::GetComponent(Entity entity) const {
+    if (!IsEntityValid(entity)) return nullptr;
+    
+    if constexpr (ComponentTrait<T>::is_sparse) {
+        const SparseSet* set = m_SparseSets.Find(ComponentRegistry::GetTypeID<T>());
+        return set ? static_cast<const T*>(set->Get(entity.id)) : nullptr;
+    }
+    
+    const EntityRecord& record = m_EntityRecords[entity.id];
+    if (!record.archetype) return nullptr;
+    
+    return static_cast<const Archetype*>(record.archetype)->GetComponent<T>(record.indexInArchetype);
+}
+
 template<typename T>
 bool World::HasComponent(Entity entity) const {
     if (!IsEntityValid(entity)) return false;
     
+    if constexpr (ComponentTrait<T>::is_sparse) {
+        const SparseSet* set = m_SparseSets.Find(ComponentRegistry::GetTypeID<T>());
+        return set && set->Contains(entity.id);
+    }
+    
     const EntityRecord& record = m_EntityRecords[entity.id];
     if (!record.archetype) return false;
     
-    ComponentTypeID typeID = ComponentRegistry::GetTypeID<T>();
-    for (const auto& info : record.archetype->GetComponentTypes()) {
-        if (info.typeID == typeID) return true;
+    return record.archetype->HasComponent(ComponentRegistry::GetTypeID<T>());
+}
+
+template<typename T>
+bool World::HasChanged(Entity entity, uint32_t sinceVersion) const {
+    if (!IsEntityValid(entity)) return false;
+    
+    const EntityRecord& record = m_EntityRecords[entity.id];
+    if (!record.archetype) return false;
+    
+    size_t column = record.archetype->GetComponentIndex(ComponentRegistry::GetTypeID<T>());
+    if (column == Archetype::INVALID_COLUMN) return false;
+    
+    const Archetype::Chunk& chunk = static_cast<const Archetype*>(record.archetype)->GetChunk(Archetype::GetChunkIndex(record.indexInArchetype));
+    return record.archetype->HasColumnChanged(chunk, column, sinceVersion);
+}
+
+template<typename... Components>
+Query<Components...>& World::GetQuery() {
+    auto key = std::type_index(typeid(Query<Components...>));
+    
+    std::lock_guard<std::mutex> lock(m_QueryMutex);
+    auto it = m_Queries.find(key);
+    if (it == m_Queries.end()) {
+        it = m_Queries.emplace(key, std::make_unique<Query<Components...>>(m_ArchetypeList, m_SparseSets)).first;
     }
-    return false;
+    
+    return static_cast<Query<Components...>&>(*it->second);
+}
+
+template<typename... Components, typename Func>
+void World::ForEach(Func&& callback) {
+    GetQuery<Components...>().ForEach(std::forward<Func>(callback));
 }
 
 }
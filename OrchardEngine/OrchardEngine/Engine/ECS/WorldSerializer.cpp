@@ -0,0 +1,640 @@
+#include "WorldSerializer.hpp"
+#include "World.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Orchard::ECS {
+
+namespace {
+
+constexpr uint32_t INVALID_INDEX = ~uint32_t(0);
+
+constexpr uint32_t SNAPSHOT_TYPE_TAG = 1 << 0;
+constexpr uint32_t SNAPSHOT_TYPE_SHARED = 1 << 1;
+constexpr uint32_t SNAPSHOT_TYPE_SPARSE = 1 << 2;
+
+struct SnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t chunkSize;
+    uint32_t typeCount;
+    uint32_t sharedValueCount;
+    uint32_t archetypeCount;
+    uint32_t sparseSetCount;
+    uint32_t chunkCount;
+    uint64_t nextEntityID;
+    uint64_t freeEntityCount;
+    uint64_t dataOffset;
+    uint64_t emptyEntityCount;
+};
+
+struct SnapshotType {
+    uint64_t stableID;
+    uint32_t size;
+    uint32_t valueSize;
+    uint32_t alignment;
+    uint32_t flags;
+    uint32_t nameLength;
+    uint32_t reserved;
+};
+
+struct SnapshotSharedValue {
+    uint32_t typeIndex;
+    uint32_t reserved;
+};
+
+struct SnapshotArchetype {
+    uint32_t componentCount;
+    uint32_t chunkCount;
+    uint32_t entitiesPerChunk;
+    uint32_t reserved;
+};
+
+struct SnapshotColumn {
+    uint32_t typeIndex;
+    uint32_t sharedValue;
+    uint64_t offsetInChunk;
+};
+
+struct SnapshotSparseSet {
+    uint32_t typeIndex;
+    uint32_t reserved;
+    uint64_t count;
+};
+
+size_t AlignOffset(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+uint32_t GetTypeFlags(const ComponentTypeInfo& typeInfo) {
+    return (typeInfo.tag ? SNAPSHOT_TYPE_TAG : 0) |
+           (typeInfo.shared ? SNAPSHOT_TYPE_SHARED : 0) |
+           (typeInfo.sparse ? SNAPSHOT_TYPE_SPARSE : 0);
+}
+
+class SnapshotWriter {
+public:
+    template<typename T>
+    void Write(const T& value) {
+        WriteBytes(&value, sizeof(T));
+    }
+    
+    void WriteBytes(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        m_Buffer.insert(m_Buffer.end(), bytes, bytes + size);
+    }
+    
+    template<typename T>
+    void Overwrite(size_t offset, const T& value) {
+        std::memcpy(m_Buffer.data() + offset, &value, sizeof(T));
+    }
+    
+    void Align(size_t alignment) {
+        m_Buffer.resize(AlignOffset(m_Buffer.size(), alignment), 0);
+    }
+    
+    const std::vector<uint8_t>& GetBuffer() const { return m_Buffer; }
+    
+private:
+    std::vector<uint8_t> m_Buffer;
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const uint8_t* data, size_t size) : m_Data(data), m_Size(size) {}
+    
+    template<typename T>
+    bool Read(T& value) {
+        const uint8_t* bytes = ReadBytes(sizeof(T));
+        if (!bytes) return false;
+        
+        std::memcpy(&value, bytes, sizeof(T));
+        return true;
+    }
+    
+    const uint8_t* ReadBytes(size_t size) {
+        if (size > m_Size - m_Offset) return nullptr;
+        
+        const uint8_t* bytes = m_Data + m_Offset;
+        m_Offset += size;
+        return bytes;
+    }
+    
+    size_t GetRemaining() const { return m_Size - m_Offset; }
+    
+    void Align(size_t alignment) {
+        m_Offset = std::min(AlignOffset(m_Offset, alignment), m_Size);
+    }
+    
+private:
+    const uint8_t* m_Data;
+    size_t m_Size;
+    size_t m_Offset = 0;
+};
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() {
+        if (m_Data) munmap(m_Data, m_Size);
+        if (m_File >= 0) close(m_File);
+    }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool Open(const std::string& path) {
+        m_File = open(path.c_str(), O_RDONLY);
+        if (m_File < 0) return false;
+        
+        struct stat info;
+        if (fstat(m_File, &info) != 0 || info.st_size <= 0) return false;
+        
+        m_Size = static_cast<size_t>(info.st_size);
+        void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_File, 0);
+        if (data == MAP_FAILED) return false;
+        
+        m_Data = data;
+        madvise(m_Data, m_Size, MADV_SEQUENTIAL);
+        return true;
+    }
+    
+    const uint8_t* GetData() const { return static_cast<const uint8_t*>(m_Data); }
+    size_t GetSize() const { return m_Size; }
+    
+private:
+    int m_File = -1;
+    void* m_Data = nullptr;
+    size_t m_Size = 0;
+};
+
+}
+
+bool WorldSerializer::Save(const World& world, const std::string& path) {
+    std::array<uint32_t, MAX_COMPONENT_TYPES> typeIndices;
+    typeIndices.fill(INVALID_INDEX);
+    std::vector<ComponentTypeID> types;
+    
+    auto addType = [&](ComponentTypeID typeID) {
+        if (typeIndices[typeID] != INVALID_INDEX) return true;
+        
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeID);
+        if (!typeInfo.named) {
+            std::cerr << "WorldSerializer: component " << typeInfo.name << " does not declare a ComponentName" << std::endl;
+            return false;
+        }
+        if (!typeInfo.tag && !typeInfo.trivialValue) {
+            std::cerr << "WorldSerializer: component " << typeInfo.name << " is not trivially copyable" << std::endl;
+            return false;
+        }
+        
+        typeIndices[typeID] = static_cast<uint32_t>(types.size());
+        types.push_back(typeID);
+        return true;
+    };
+    
+    std::vector<const Archetype*> archetypes;
+    std::map<std::pair<ComponentTypeID, uint32_t>, uint32_t> sharedIndices;
+    std::vector<std::pair<ComponentTypeID, const void*>> sharedValues;
+    uint32_t chunkCount = 0;
+    for (const Archetype* archetype : world.m_ArchetypeList) {
+        if (archetype->GetEntityCount() == 0) continue;
+        
+        for (const ComponentInfo& info : archetype->GetComponentTypes()) {
+            if (!addType(info.typeID)) return false;
+            
+            auto key = std::make_pair(info.typeID, info.sharedIndex);
+            if (info.sharedValue && sharedIndices.emplace(key, static_cast<uint32_t>(sharedValues.size())).second) {
+                sharedValues.emplace_back(info.typeID, info.sharedValue);
+            }
+        }
+        
+        for (size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+            const Archetype::Chunk& chunk = archetype->GetChunk(c);
+            if (chunk.data && chunk.entityCount > 0) ++chunkCount;
+        }
+        archetypes.push_back(archetype);
+    }
+    
+    std::vector<const SparseSet*> sparseSets;
+    for (ComponentTypeID typeID = 0; typeID < ComponentRegistry::GetTypeCount(); ++typeID) {
+        const SparseSet* set = world.m_SparseSets.Find(typeID);
+        if (!set || set->GetCount() == 0) continue;
+        if (!addType(typeID)) return false;
+        
+        sparseSets.push_back(set);
+    }
+    
+    SnapshotWriter writer;
+    writer.Write(SnapshotHeader{});
+    
+    for (EntityID id : world.m_FreeEntities) {
+        writer.Write<uint64_t>(id);
+    }
+    
+    uint64_t emptyEntityCount = 0;
+    for (EntityID id = 1; id < world.m_NextEntityID; ++id) {
+        const World::EntityRecord& record = world.m_EntityRecords[id];
+        if (record.alive && !record.archetype) {
+            writer.Write<uint64_t>(id);
+            ++emptyEntityCount;
+        }
+    }
+    
+    for (ComponentTypeID typeID : types) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeID);
+        uint32_t nameLength = static_cast<uint32_t>(std::strlen(typeInfo.name));
+        writer.Write(SnapshotType{ typeInfo.stableID, static_cast<uint32_t>(typeInfo.size), static_cast<uint32_t>(typeInfo.valueSize),
+                                   static_cast<uint32_t>(typeInfo.alignment), GetTypeFlags(typeInfo), nameLength, 0 });
+        writer.WriteBytes(typeInfo.name, nameLength);
+        writer.Align(8);
+    }
+    
+    for (const auto& [typeID, value] : sharedValues) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeID);
+        writer.Write(SnapshotSharedValue{ typeIndices[typeID], 0 });
+        writer.Align(std::max<size_t>(typeInfo.alignment, 8));
+        writer.WriteBytes(value, typeInfo.valueSize);
+        writer.Align(8);
+    }
+    
+    for (const Archetype* archetype : archetypes) {
+        const auto& components = archetype->GetComponentTypes();
+        std::vector<uint32_t> entityCounts;
+        for (size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+            const Archetype::Chunk& chunk = archetype->GetChunk(c);
+            if (chunk.data && chunk.entityCount > 0) {
+                entityCounts.push_back(static_cast<uint32_t>(chunk.entityCount));
+            }
+        }
+        
+        writer.Write(SnapshotArchetype{ static_cast<uint32_t>(components.size()), static_cast<uint32_t>(entityCounts.size()),
+                                        static_cast<uint32_t>(archetype->GetEntitiesPerChunk()), 0 });
+        for (const ComponentInfo& info : components) {
+            uint32_t sharedValue = info.sharedValue ? sharedIndices.at(std::make_pair(info.typeID, info.sharedIndex)) : INVALID_INDEX;
+            writer.Write(SnapshotColumn{ typeIndices[info.typeID], sharedValue, info.offsetInChunk });
+        }
+        for (uint32_t entityCount : entityCounts) {
+            writer.Write(entityCount);
+        }
+        writer.Align(8);
+    }
+    
+    for (const SparseSet* set : sparseSets) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(set->GetTypeID());
+        writer.Write(SnapshotSparseSet{ typeIndices[set->GetTypeID()], 0, set->GetCount() });
+        for (size_t i = 0; i < set->GetCount(); ++i) {
+            writer.Write<uint64_t>(set->GetEntity(i).id);
+        }
+        writer.Align(std::max<size_t>(typeInfo.alignment, 8));
+        for (size_t i = 0; i < set->GetCount(); ++i) {
+            writer.WriteBytes(set->GetValue(i), typeInfo.valueSize);
+        }
+        writer.Align(8);
+    }
+    
+    SnapshotHeader header{};
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.chunkSize = static_cast<uint32_t>(CHUNK_SIZE);
+    header.typeCount = static_cast<uint32_t>(types.size());
+    header.sharedValueCount = static_cast<uint32_t>(sharedValues.size());
+    header.archetypeCount = static_cast<uint32_t>(archetypes.size());
+    header.sparseSetCount = static_cast<uint32_t>(sparseSets.size());
+    header.chunkCount = chunkCount;
+    header.nextEntityID = world.m_NextEntityID;
+    header.freeEntityCount = world.m_FreeEntities.size();
+    header.emptyEntityCount = emptyEntityCount;
+    header.dataOffset = AlignOffset(writer.GetBuffer().size(), CHUNK_SIZE);
+    writer.Overwrite(0, header);
+    
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "WorldSerializer: failed to open " << path << " for writing" << std::endl;
+        return false;
+    }
+    
+    const std::vector<uint8_t>& metadata = writer.GetBuffer();
+    std::vector<char> padding(header.dataOffset - metadata.size(), 0);
+    file.write(reinterpret_cast<const char*>(metadata.data()), metadata.size());
+    file.write(padding.data(), padding.size());
+    
+    for (const Archetype* archetype : archetypes) {
+        for (size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+            const Archetype::Chunk& chunk = archetype->GetChunk(c);
+            if (chunk.data && chunk.entityCount > 0) {
+                file.write(reinterpret_cast<const char*>(chunk.data), CHUNK_SIZE);
+            }
+        }
+    }
+    
+    if (!file) {
+        std::cerr << "WorldSerializer: failed to write " << path << std::endl;
+        return false;
+    }
+    
+    return true;
+}
+
+bool WorldSerializer::Load(World& world, const std::string& path) {
+    auto fail = [&path](const char* reason) {
+        std::cerr << "WorldSerializer: " << path << ": " << reason << std::endl;
+        return false;
+    };
+    
+    if (world.m_NextEntityID != 1) {
+        return fail("snapshots can only be loaded into an empty world");
+    }
+    
+    MappedFile file;
+    if (!file.Open(path)) {
+        return fail("failed to map file");
+    }
+    
+    SnapshotReader reader(file.GetData(), file.GetSize());
+    SnapshotHeader header;
+    if (!reader.Read(header) || header.magic != SNAPSHOT_MAGIC) {
+        return fail("not a world snapshot");
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        return fail("unsupported snapshot version");
+    }
+    if (header.chunkSize != CHUNK_SIZE) {
+        return fail("snapshot was written with a different chunk size");
+    }
+    if (header.dataOffset > file.GetSize() || header.chunkCount > (file.GetSize() - header.dataOffset) / CHUNK_SIZE) {
+        return fail("chunk data is truncated");
+    }
+    
+    // Every entity is either free, listed as empty or stored in a chunk, which bounds the
+    // entity table by the size of the file.
+    uint64_t entityIDCount = reader.GetRemaining() / sizeof(uint64_t);
+    if (header.nextEntityID == 0 || header.freeEntityCount > entityIDCount ||
+        header.emptyEntityCount > entityIDCount - header.freeEntityCount ||
+        header.nextEntityID - 1 > header.freeEntityCount + header.emptyEntityCount +
+                                  uint64_t(header.chunkCount) * (CHUNK_SIZE / sizeof(Entity))) {
+        return fail("corrupt entity table");
+    }
+    
+    std::vector<EntityID> freeEntities(header.freeEntityCount);
+    std::vector<EntityID> emptyEntities(header.emptyEntityCount);
+    for (std::vector<EntityID>* ids : { &freeEntities, &emptyEntities }) {
+        for (EntityID& id : *ids) {
+            uint64_t value;
+            if (!reader.Read(value) || value == NULL_ENTITY || value >= header.nextEntityID) {
+                return fail("corrupt entity table");
+            }
+            id = value;
+        }
+    }
+    
+    std::vector<ComponentTypeID> typeIDs;
+    for (uint32_t i = 0; i < header.typeCount; ++i) {
+        SnapshotType type;
+        if (!reader.Read(type)) return fail("corrupt type table");
+        
+        const uint8_t* name = reader.ReadBytes(type.nameLength);
+        if (!name) return fail("corrupt type table");
+        reader.Align(8);
+        
+        std::string typeName(reinterpret_cast<const char*>(name), type.nameLength);
+        ComponentTypeID typeID = ComponentRegistry::FindTypeID(type.stableID);
+        if (typeID == INVALID_COMPONENT_TYPE) {
+            std::cerr << "WorldSerializer: component " << typeName << " is not registered" << std::endl;
+            return false;
+        }
+        
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeID);
+        if (typeInfo.size != type.size || typeInfo.valueSize != type.valueSize ||
+            typeInfo.alignment != type.alignment || GetTypeFlags(typeInfo) != type.flags) {
+            std::cerr << "WorldSerializer: layout of component " << typeName << " has changed" << std::endl;
+            return false;
+        }
+        typeIDs.push_back(typeID);
+    }
+    
+    std::vector<std::pair<ComponentTypeID, const uint8_t*>> sharedValues;
+    for (uint32_t i = 0; i < header.sharedValueCount; ++i) {
+        SnapshotSharedValue shared;
+        if (!reader.Read(shared) || shared.typeIndex >= typeIDs.size()) return fail("corrupt shared value table");
+        
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeIDs[shared.typeIndex]);
+        if (!typeInfo.shared) return fail("corrupt shared value table");
+        
+        reader.Align(std::max<size_t>(typeInfo.alignment, 8));
+        const uint8_t* value = reader.ReadBytes(typeInfo.valueSize);
+        if (!value) return fail("corrupt shared value table");
+        reader.Align(8);
+        
+        sharedValues.emplace_back(typeInfo.id, value);
+    }
+    
+    enum EntityState : uint8_t { ENTITY_UNSEEN, ENTITY_FREE, ENTITY_EMPTY, ENTITY_PLACED };
+    std::vector<uint8_t> entityStates(header.nextEntityID, ENTITY_UNSEEN);
+    entityStates[NULL_ENTITY] = ENTITY_FREE;
+    for (EntityID id : freeEntities) {
+        if (entityStates[id] != ENTITY_UNSEEN) return fail("corrupt entity table");
+        entityStates[id] = ENTITY_FREE;
+    }
+    for (EntityID id : emptyEntities) {
+        if (entityStates[id] != ENTITY_UNSEEN) return fail("corrupt entity table");
+        entityStates[id] = ENTITY_EMPTY;
+    }
+    
+    struct ArchetypeTable {
+        std::vector<SnapshotColumn> columns;
+        std::vector<uint32_t> entityCounts;
+        uint32_t entitiesPerChunk;
+    };
+    
+    const uint8_t* chunkData = file.GetData() + header.dataOffset;
+    if (header.archetypeCount > reader.GetRemaining() / sizeof(SnapshotArchetype)) {
+        return fail("corrupt archetype table");
+    }
+    
+    std::vector<ArchetypeTable> archetypes(header.archetypeCount);
+    size_t chunkCursor = 0;
+    for (ArchetypeTable& table : archetypes) {
+        SnapshotArchetype entry;
+        if (!reader.Read(entry) || entry.entitiesPerChunk == 0 ||
+            entry.entitiesPerChunk > CHUNK_SIZE / sizeof(Entity) || entry.componentCount > MAX_COMPONENT_TYPES ||
+            entry.componentCount > reader.GetRemaining() / sizeof(SnapshotColumn)) {
+            return fail("corrupt archetype table");
+        }
+        if (entry.chunkCount > header.chunkCount - chunkCursor) {
+            return fail("chunk data is truncated");
+        }
+        table.entitiesPerChunk = entry.entitiesPerChunk;
+        
+        ComponentSignature signature;
+        table.columns.resize(entry.componentCount);
+        for (SnapshotColumn& column : table.columns) {
+            if (!reader.Read(column) || column.typeIndex >= typeIDs.size()) return fail("corrupt archetype table");
+            
+            const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeIDs[column.typeIndex]);
+            if (typeInfo.sparse || signature.test(typeInfo.id) || typeInfo.shared != (column.sharedValue != INVALID_INDEX) ||
+                (typeInfo.shared && (column.sharedValue >= sharedValues.size() ||
+                                     sharedValues[column.sharedValue].first != typeInfo.id)) ||
+                column.offsetInChunk + typeInfo.size * entry.entitiesPerChunk > CHUNK_SIZE) {
+                return fail("corrupt archetype table");
+            }
+            signature.set(typeInfo.id);
+        }
+        
+        table.entityCounts.resize(entry.chunkCount);
+        for (uint32_t& entityCount : table.entityCounts) {
+            if (!reader.Read(entityCount) || entityCount > entry.entitiesPerChunk) return fail("corrupt archetype table");
+        }
+        reader.Align(8);
+        
+        for (uint32_t entityCount : table.entityCounts) {
+            const uint8_t* source = chunkData + (chunkCursor++) * CHUNK_SIZE;
+            for (size_t row = 0; row < entityCount; ++row) {
+                Entity entity;
+                std::memcpy(&entity, source + row * sizeof(Entity), sizeof(Entity));
+                if (entity.id >= header.nextEntityID || entityStates[entity.id] != ENTITY_UNSEEN) {
+                    return fail("corrupt entity data");
+                }
+                entityStates[entity.id] = ENTITY_PLACED;
+            }
+        }
+    }
+    if (std::find(entityStates.begin(), entityStates.end(), ENTITY_UNSEEN) != entityStates.end()) {
+        return fail("corrupt entity table");
+    }
+    
+    struct SparseSetTable {
+        ComponentTypeID typeID;
+        uint64_t count;
+        const uint8_t* ids;
+        const uint8_t* values;
+    };
+    
+    std::vector<SparseSetTable> sparseSets;
+    std::vector<EntityID> sparseIDs;
+    for (uint32_t s = 0; s < header.sparseSetCount; ++s) {
+        SnapshotSparseSet entry;
+        if (!reader.Read(entry) || entry.typeIndex >= typeIDs.size() ||
+            entry.count > reader.GetRemaining() / sizeof(uint64_t)) {
+            return fail("corrupt sparse set table");
+        }
+        
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeIDs[entry.typeIndex]);
+        if (!typeInfo.sparse) return fail("corrupt sparse set table");
+        
+        const uint8_t* ids = reader.ReadBytes(entry.count * sizeof(uint64_t));
+        reader.Align(std::max<size_t>(typeInfo.alignment, 8));
+        const uint8_t* values = entry.count <= reader.GetRemaining() / typeInfo.valueSize
+            ? reader.ReadBytes(entry.count * typeInfo.valueSize) : nullptr;
+        if (!ids || !values) return fail("corrupt sparse set table");
+        reader.Align(8);
+        
+        sparseIDs.resize(entry.count);
+        std::memcpy(sparseIDs.data(), ids, entry.count * sizeof(uint64_t));
+        for (EntityID id : sparseIDs) {
+            if (id >= header.nextEntityID || entityStates[id] == ENTITY_FREE) return fail("corrupt sparse set table");
+        }
+        std::sort(sparseIDs.begin(), sparseIDs.end());
+        if (std::adjacent_find(sparseIDs.begin(), sparseIDs.end()) != sparseIDs.end()) {
+            return fail("corrupt sparse set table");
+        }
+        
+        sparseSets.push_back(SparseSetTable{ typeInfo.id, entry.count, ids, values });
+    }
+    
+    std::vector<uint32_t> sharedIndices;
+    for (const auto& [typeID, value] : sharedValues) {
+        sharedIndices.push_back(world.m_SharedComponents.Intern(typeID, value));
+    }
+    
+    world.m_NextEntityID = header.nextEntityID;
+    if (world.m_EntityRecords.size() < header.nextEntityID) {
+        world.m_EntityRecords.resize(header.nextEntityID);
+    }
+    for (EntityID id = 1; id < header.nextEntityID; ++id) {
+        world.m_EntityRecords[id] = World::EntityRecord{ nullptr, 0, entityStates[id] != ENTITY_FREE };
+    }
+    world.m_FreeEntities = std::move(freeEntities);
+    
+    auto adoptEntities = [&world](Archetype* archetype, size_t chunkIndex) {
+        const Archetype::Chunk& chunk = archetype->GetChunk(chunkIndex);
+        const Entity* entities = chunk.GetEntities();
+        for (size_t row = 0; row < chunk.entityCount; ++row) {
+            World::EntityRecord& record = world.m_EntityRecords[entities[row].id];
+            record.archetype = archetype;
+            record.indexInArchetype = Archetype::MakeIndex(chunkIndex, row);
+        }
+    };
+    
+    chunkCursor = 0;
+    for (const ArchetypeTable& table : archetypes) {
+        std::vector<ComponentInfo> components;
+        for (const SnapshotColumn& column : table.columns) {
+            const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(typeIDs[column.typeIndex]);
+            components.push_back(ComponentInfo(typeInfo.id, 0, 0,
+                typeInfo.shared ? sharedIndices[column.sharedValue] : INVALID_SHARED_INDEX));
+        }
+        
+        Archetype* archetype = world.GetOrCreateArchetype(components);
+        const auto& infos = archetype->GetComponentTypes();
+        
+        bool sameLayout = archetype->GetEntitiesPerChunk() == table.entitiesPerChunk;
+        for (const SnapshotColumn& column : table.columns) {
+            const ComponentInfo& info = infos[archetype->GetComponentIndex(typeIDs[column.typeIndex])];
+            if (info.size > 0 && info.offsetInChunk != column.offsetInChunk) {
+                sameLayout = false;
+            }
+        }
+        
+        for (uint32_t entityCount : table.entityCounts) {
+            const uint8_t* source = chunkData + (chunkCursor++) * CHUNK_SIZE;
+            
+            if (sameLayout) {
+                size_t chunkIndex = archetype->AppendChunk(entityCount);
+                std::memcpy(archetype->GetChunk(chunkIndex).data, source, CHUNK_SIZE);
+                adoptEntities(archetype, chunkIndex);
+                continue;
+            }
+            
+            for (size_t first = 0; first < entityCount;) {
+                size_t batch = std::min<size_t>(entityCount - first, archetype->GetEntitiesPerChunk());
+                size_t chunkIndex = archetype->AppendChunk(batch);
+                Archetype::Chunk& chunk = archetype->GetChunk(chunkIndex);
+                
+                std::memcpy(chunk.data, source + first * sizeof(Entity), batch * sizeof(Entity));
+                for (const SnapshotColumn& column : table.columns) {
+                    const ComponentInfo& info = infos[archetype->GetComponentIndex(typeIDs[column.typeIndex])];
+                    if (info.size == 0) continue;
+                    
+                    std::memcpy(chunk.data + info.offsetInChunk, source + column.offsetInChunk + first * info.size,
+                                batch * info.size);
+                }
+                
+                adoptEntities(archetype, chunkIndex);
+                first += batch;
+            }
+        }
+    }
+    
+    for (const SparseSetTable& table : sparseSets) {
+        const ComponentTypeInfo& typeInfo = ComponentRegistry::GetTypeInfo(table.typeID);
+        SparseSet& set = world.m_SparseSets.GetOrCreate(table.typeID);
+        for (size_t i = 0; i < table.count; ++i) {
+            EntityID id;
+            std::memcpy(&id, table.ids + i * sizeof(uint64_t), sizeof(uint64_t));
+            std::memcpy(set.Emplace(Entity(id, 0)), table.values + i * typeInfo.valueSize, typeInfo.valueSize);
+        }
+    }
+    
+    return true;
+}
+
+}
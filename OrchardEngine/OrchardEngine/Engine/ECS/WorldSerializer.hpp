@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace Orchard::ECS {
+
+class World;
+
+class WorldSerializer {
+public:
+    static constexpr uint32_t SNAPSHOT_MAGIC = 0x5743524F;
+    static constexpr uint32_t SNAPSHOT_VERSION = 3;
+    
+    static bool Save(const World& world, const std::string& path);
+    static bool Load(World& world, const std::string& path);
+};
+
+}
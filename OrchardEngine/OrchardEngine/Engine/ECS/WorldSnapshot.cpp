@@ -0,0 +1,72 @@
+#include "WorldSnapshot.hpp"
+#include "World.hpp"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace Orchard::ECS {
+
+WorldSnapshot::Chunk::Chunk(std::shared_ptr<ChunkPool> pool, const uint8_t* source, size_t entityCount)
+    : m_Pool(std::move(pool))
+    , m_Data(m_Pool->Allocate())
+    , m_EntityCount(entityCount)
+{
+    std::memcpy(m_Data, source, CHUNK_SIZE);
+}
+
+WorldSnapshot::Chunk::~Chunk() {
+    m_Pool->Deallocate(m_Data);
+}
+
+std::shared_ptr<const WorldSnapshot> WorldSnapshot::Capture(World& world, const WorldSnapshot* previous) {
+    auto snapshot = std::make_shared<WorldSnapshot>();
+    snapshot->m_Version = world.AdvanceChangeVersion();
+    
+    const std::vector<Archetype*>& archetypes = world.GetArchetypes();
+    snapshot->m_Archetypes.reserve(archetypes.size());
+    for (size_t a = 0; a < archetypes.size(); ++a) {
+        const Archetype* archetype = archetypes[a];
+        const ArchetypeEntry* previousEntry = previous && a < previous->m_Archetypes.size()
+            ? &previous->m_Archetypes[a] : nullptr;
+        
+        ArchetypeEntry entry{ previousEntry ? previousEntry->layout : nullptr, {}, {} };
+        if (!entry.layout) {
+            auto layout = std::make_shared<Layout>();
+            layout->signature = archetype->GetSignature();
+            for (const ComponentInfo& info : archetype->GetComponentTypes()) {
+                layout->types.push_back(info.typeID);
+                layout->offsets.push_back(info.offsetInChunk);
+            }
+            entry.layout = std::move(layout);
+        }
+        entry.chunks.resize(archetype->GetChunkCount());
+        for (size_t i = 0; i < archetype->GetComponentTypes().size(); ++i) {
+            entry.sharedValues.push_back(archetype->GetSharedValue(i));
+        }
+        for (size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+            const Archetype::Chunk& chunk = archetype->GetChunk(c);
+            if (!chunk.data || chunk.entityCount == 0) continue;
+            
+            snapshot->m_EntityCount += chunk.entityCount;
+            
+            const std::shared_ptr<const Chunk>* shared = previousEntry && c < previousEntry->chunks.size()
+                ? &previousEntry->chunks[c] : nullptr;
+            if (shared && *shared && (*shared)->GetEntityCount() == chunk.entityCount &&
+                std::none_of(chunk.columnVersions.begin(), chunk.columnVersions.end(),
+                    [previous](uint32_t version) { return Archetype::IsNewerVersion(version, previous->m_Version); })) {
+                entry.chunks[c] = *shared;
+                ++snapshot->m_SharedChunks;
+                continue;
+            }
+            
+            entry.chunks[c] = std::make_shared<const Chunk>(world.GetSharedChunkPool(), chunk.data, chunk.entityCount);
+            ++snapshot->m_CopiedChunks;
+        }
+        
+        snapshot->m_Archetypes.push_back(std::move(entry));
+    }
+    
+    return snapshot;
+}
+
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Archetype.hpp"
+#include "Query.hpp"
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Orchard::ECS {
+
+class World;
+
+class WorldSnapshot {
+public:
+    class Chunk {
+    public:
+        Chunk(std::shared_ptr<ChunkPool> pool, const uint8_t* source, size_t entityCount);
+        ~Chunk();
+        
+        Chunk(const Chunk&) = delete;
+        Chunk& operator=(const Chunk&) = delete;
+        
+        const uint8_t* GetData() const { return m_Data; }
+        size_t GetEntityCount() const { return m_EntityCount; }
+        const Entity* GetEntities() const { return reinterpret_cast<const Entity*>(m_Data); }
+        
+    private:
+        std::shared_ptr<ChunkPool> m_Pool;
+        uint8_t* m_Data;
+        size_t m_EntityCount;
+    };
+    
+    static std::shared_ptr<const WorldSnapshot> Capture(World& world, const WorldSnapshot* previous);
+    
+    uint32_t GetVersion() const { return m_Version; }
+    size_t GetEntityCount() const { return m_EntityCount; }
+    size_t GetCopiedChunkCount() const { return m_CopiedChunks; }
+    size_t GetSharedChunkCount() const { return m_SharedChunks; }
+    
+    template<typename... Components, typename Func>
+    void ForEachChunk(Func&& func) const;
+    
+    template<typename... Components, typename Func>
+    void ForEach(Func&& func) const;
+    
+private:
+    struct Layout {
+        ComponentSignature signature;
+        std::vector<ComponentTypeID> types;
+        std::vector<size_t> offsets;
+        
+        size_t GetColumn(ComponentTypeID typeID) const {
+            return std::find(types.begin(), types.end(), typeID) - types.begin();
+        }
+    };
+    
+    struct ArchetypeEntry {
+        std::shared_ptr<const Layout> layout;
+        std::vector<std::shared_ptr<const Chunk>> chunks;
+        std::vector<std::shared_ptr<const void>> sharedValues;
+    };
+    
+    template<typename T>
+    static const T* GetColumn(const ArchetypeEntry& entry, const Chunk& chunk, size_t column) {
+        if (entry.sharedValues[column]) return static_cast<const T*>(entry.sharedValues[column].get());
+        return reinterpret_cast<const T*>(chunk.GetData() + entry.layout->offsets[column]);
+    }
+    
+    template<typename... Components, typename Func, size_t... I>
+    static void InvokeChunk(Func& func, const ArchetypeEntry& entry, const Chunk& chunk,
+                            const std::array<size_t, sizeof...(Components)>& columns, std::index_sequence<I...>) {
+        func(chunk.GetEntityCount(), chunk.GetEntities(), GetColumn<Components>(entry, chunk, columns[I])...);
+    }
+    
+    std::vector<ArchetypeEntry> m_Archetypes;
+    uint32_t m_Version = 0;
+    size_t m_EntityCount = 0;
+    size_t m_CopiedChunks = 0;
+    size_t m_SharedChunks = 0;
+};
+
+template<typename... Components, typename Func>
+void WorldSnapshot::ForEachChunk(Func&& func) const {
+    static_assert(((std::is_trivially_copyable_v<Components> && !ComponentTrait<Components>::is_sparse) && ...),
+                  "Snapshots only expose trivially copyable archetype components");
+    
+    ComponentSignature signature;
+    (signature.set(ComponentRegistry::GetTypeID<Components>()), ...);
+    
+    for (const ArchetypeEntry& entry : m_Archetypes) {
+        const Layout& layout = *entry.layout;
+        if ((layout.signature & signature) != signature) continue;
+        
+        std::array<size_t, sizeof...(Components)> columns{
+            layout.GetColumn(ComponentRegistry::GetTypeID<Components>())...
+        };
+        for (const auto& chunk : entry.chunks) {
+            if (chunk) {
+                InvokeChunk<Components...>(func, entry, *chunk, columns, std::index_sequence_for<Components...>{});
+            }
+        }
+    }
+}
+
+template<typename... Components, typename Func>
+void WorldSnapshot::ForEach(Func&& func) const {
+    ForEachChunk<Components...>([&func](size_t count, const Entity* entities, const Components*... columns) {
+        for (size_t i = 0; i < count; ++i) {
+            func(entities[i], QueryTerm<const Components>::Element(columns, i)...);
+        }
+    });
+}
+
+}
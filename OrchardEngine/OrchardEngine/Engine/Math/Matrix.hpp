@@ -124,6 +124,22 @@ struct alignas(16) Matrix4 {
         return result;
     }
     
+    static void Multiply(const Matrix4& a, const Matrix4& b, Matrix4& result) {
+        float32x4_t out[4];
+        for (int i = 0; i < 4; ++i) {
+            float32x4_t row = a.rows[i];
+            float32x4_t sum = vmulq_laneq_f32(b.rows[0], row, 0);
+            sum = vfmaq_laneq_f32(sum, b.rows[1], row, 1);
+            sum = vfmaq_laneq_f32(sum, b.rows[2], row, 2);
+            sum = vfmaq_laneq_f32(sum, b.rows[3], row, 3);
+            out[i] = sum;
+        }
+        
+        for (int i = 0; i < 4; ++i) {
+            result.rows[i] = out[i];
+        }
+    }
+    
     Vector4 operator*(const Vector4& vec) const {
         Vector4 result;
         
@@ -56,6 +56,10 @@ public:
         return m_Rotation * Vector3(0, 1, 0);
     }
     
+    void MarkDirty() const {
+        m_MatrixDirty = true;
+    }
+    
     const Matrix4& GetMatrix() const {
         if (m_MatrixDirty) {
             m_Matrix = Matrix4::TRS(m_Position, m_Rotation, m_Scale);
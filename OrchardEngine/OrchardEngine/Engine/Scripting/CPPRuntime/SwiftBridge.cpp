@@ -2,9 +2,134 @@
 #include "../../Core/Engine.hpp"
 #include "../../ECS/World.hpp"
 #include "../../ECS/Components/TransformComponent.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
 
 using namespace Orchard;
 
+static_assert(sizeof(CEntity) == sizeof(ECS::Entity) &&
+              offsetof(CEntity, id) == offsetof(ECS::Entity, id) &&
+              offsetof(CEntity, version) == offsetof(ECS::Entity, version),
+              "CEntity must alias ECS::Entity so chunk entity arrays can be handed out directly");
+
+static void ApplyTransform(ECS::TransformComponent& tc, const CTransform& transform) {
+    tc.SetPosition(Math::Vector3(transform.positionX, transform.positionY, transform.positionZ));
+    tc.SetRotation(Math::Quaternion(transform.rotationX, transform.rotationY,
+                                    transform.rotationZ, transform.rotationW));
+    tc.SetScale(Math::Vector3(transform.scaleX, transform.scaleY, transform.scaleZ));
+}
+
+namespace {
+
+class ScriptChunkSystem : public ECS::System {
+public:
+    ScriptChunkSystem(std::string name, std::vector<ECS::ComponentTypeID> reads, std::vector<ECS::ComponentTypeID> writes,
+                      CChunkSystemCallback callback, void* userData)
+        : m_Name(std::move(name))
+        , m_Callback(callback)
+        , m_UserData(userData)
+    {
+        m_Access.reads = reads;
+        m_Access.writes = writes;
+        m_Access.exclusive = false;
+        
+        m_Types = std::move(reads);
+        m_Types.insert(m_Types.end(), writes.begin(), writes.end());
+        m_WriteBegin = m_Access.reads.size();
+        for (ECS::ComponentTypeID typeID : m_Types) {
+            m_Signature.set(typeID);
+        }
+        m_Columns.resize(m_Types.size());
+        m_Strides.resize(m_Types.size());
+    }
+    
+    void OnUpdate(ECS::World* world, double deltaTime) override {
+        const std::vector<ECS::Archetype*>& archetypes = world->GetArchetypes();
+        for (; m_ArchetypeCursor < archetypes.size(); ++m_ArchetypeCursor) {
+            ECS::Archetype* archetype = archetypes[m_ArchetypeCursor];
+            if ((archetype->GetSignature() & m_Signature) == m_Signature) {
+                m_Matches.push_back(archetype);
+            }
+        }
+        
+        for (ECS::Archetype* archetype : m_Matches) {
+            for (size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+                ECS::Archetype::Chunk& chunk = archetype->GetChunk(c);
+                if (chunk.entityCount == 0) continue;
+                
+                for (size_t i = 0; i < m_Types.size(); ++i) {
+                    size_t column = archetype->GetComponentIndex(m_Types[i]);
+                    const ECS::ComponentInfo& info = archetype->GetComponentTypes()[column];
+                    if (info.sharedValue) {
+                        m_Columns[i] = const_cast<void*>(info.sharedValue);
+                        m_Strides[i] = 0;
+                    } else if (info.size == 0) {
+                        m_Columns[i] = nullptr;
+                        m_Strides[i] = 0;
+                    } else {
+                        m_Columns[i] = archetype->GetColumn(chunk, column);
+                        m_Strides[i] = static_cast<uint32_t>(info.size);
+                        if (i >= m_WriteBegin) {
+                            archetype->MarkColumnChanged(chunk, column);
+                        }
+                    }
+                }
+                
+                CChunkView view{
+                    reinterpret_cast<const CEntity*>(chunk.GetEntities()),
+                    m_Columns.data(),
+                    m_Strides.data(),
+                    static_cast<uint32_t>(chunk.entityCount),
+                    static_cast<uint32_t>(m_Columns.size())
+                };
+                m_Callback(&view, deltaTime, m_UserData);
+            }
+        }
+    }
+    
+    const char* GetName() const override { return m_Name.c_str(); }
+    
+private:
+    std::string m_Name;
+    CChunkSystemCallback m_Callback;
+    void* m_UserData;
+    std::vector<ECS::ComponentTypeID> m_Types;
+    size_t m_WriteBegin = 0;
+    ECS::ComponentSignature m_Signature;
+    std::vector<ECS::Archetype*> m_Matches;
+    size_t m_ArchetypeCursor = 0;
+    std::vector<void*> m_Columns;
+    std::vector<uint32_t> m_Strides;
+};
+
+bool ResolveQueryTypes(const uint64_t* stableIDs, uint32_t count, bool writable,
+                       std::vector<ECS::ComponentTypeID>& outTypes) {
+    for (uint32_t i = 0; i < count; ++i) {
+        ECS::ComponentTypeID typeID = ECS::ComponentRegistry::FindTypeID(stableIDs[i]);
+        if (typeID == ECS::INVALID_COMPONENT_TYPE) {
+            std::cerr << "Script query references unregistered component " << stableIDs[i] << std::endl;
+            return false;
+        }
+        
+        const ECS::ComponentTypeInfo& typeInfo = ECS::ComponentRegistry::GetTypeInfo(typeID);
+        if (typeInfo.sparse) {
+            std::cerr << "Script queries cannot iterate sparse component " << typeInfo.name << std::endl;
+            return false;
+        }
+        if (writable && typeInfo.shared) {
+            std::cerr << "Script queries cannot write shared component " << typeInfo.name << std::endl;
+            return false;
+        }
+        outTypes.push_back(typeID);
+    }
+    return true;
+}
+
+}
+
 extern "C" {
 
 void* engine_create() {
@@ -69,10 +194,7 @@ void world_add_transform_component(void* world, CEntity entity, CTransform* tran
     ECS::Entity e{ entity.id, entity.version };
     
     ECS::TransformComponent tc;
-    tc.SetPosition(Math::Vector3(transform->positionX, transform->positionY, transform->positionZ));
-    tc.SetRotation(Math::Quaternion(transform->rotationX, transform->rotationY, 
-                                    transform->rotationZ, transform->rotationW));
-    tc.SetScale(Math::Vector3(transform->scaleX, transform->scaleY, transform->scaleZ));
+    ApplyTransform(tc, *transform);
     
     w->AddComponent(e, tc);
 }
@@ -82,4 +204,142 @@ void world_update(void* world, double deltaTime) {
     w->Update(deltaTime);
 }
 
+void world_create_entities(void* world, uint32_t count, const CTransform* transforms, CEntity* outEntities) {
+    ECS::World* w = static_cast<ECS::World*>(world);
+    
+    std::vector<ECS::Entity> entities;
+    if (transforms) {
+        std::vector<ECS::TransformComponent> values(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            ApplyTransform(values[i], transforms[i]);
+        }
+        entities = w->CreateEntities(count, { ECS::ComponentRegistry::GetTypeID<ECS::TransformComponent>() },
+                                     { values.data() }, std::max<size_t>(count, 1));
+    } else {
+        entities = w->CreateEntities(count, {}, {});
+    }
+    
+    if (outEntities) {
+        for (uint32_t i = 0; i < count; ++i) {
+            outEntities[i] = CEntity{ entities[i].id, entities[i].version };
+        }
+    }
+}
+
+void world_destroy_entities(void* world, const CEntity* entities, uint32_t count) {
+    ECS::World* w = static_cast<ECS::World*>(world);
+    
+    std::vector<ECS::Entity> batch;
+    batch.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        batch.emplace_back(entities[i].id, entities[i].version);
+    }
+    w->DestroyEntities(batch);
+}
+
+uint32_t world_set_transforms(void* world, const CEntity* entities, const CTransform* transforms, uint32_t count) {
+    ECS::World* w = static_cast<ECS::World*>(world);
+    
+    uint32_t applied = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        ECS::Entity e{ entities[i].id, entities[i].version };
+        if (!w->IsEntityValid(e)) continue;
+        
+        if (ECS::TransformComponent* tc = w->GetComponent<ECS::TransformComponent>(e)) {
+            ApplyTransform(*tc, transforms[i]);
+        } else {
+            ECS::TransformComponent added;
+            ApplyTransform(added, transforms[i]);
+            w->AddComponent(e, added);
+        }
+        ++applied;
+    }
+    return applied;
+}
+
+uint32_t world_get_column_views(void* world, uint64_t componentID, bool writable, CColumnView* outViews, uint32_t maxViews) {
+    ECS::World* w = static_cast<ECS::World*>(world);
+    
+    ECS::ComponentTypeID typeID = ECS::ComponentRegistry::FindTypeID(componentID);
+    if (typeID == ECS::INVALID_COMPONENT_TYPE) return 0;
+    
+    const ECS::ComponentTypeInfo& typeInfo = ECS::ComponentRegistry::GetTypeInfo(typeID);
+    if (typeInfo.tag || typeInfo.shared || typeInfo.sparse) {
+        std::cerr << "Component " << typeInfo.name << " has no chunk column to view" << std::endl;
+        return 0;
+    }
+    
+    bool isTransform = typeID == ECS::ComponentRegistry::GetTypeID<ECS::TransformComponent>();
+    
+    uint32_t viewCount = 0;
+    for (ECS::Archetype* archetype : w->GetArchetypes()) {
+        if (!archetype->GetSignature().test(typeID)) continue;
+        
+        size_t column = archetype->GetComponentIndex(typeID);
+        for (size_t c = 0; c < archetype->GetChunkCount(); ++c) {
+            ECS::Archetype::Chunk& chunk = archetype->GetChunk(c);
+            if (chunk.entityCount == 0) continue;
+            
+            if (outViews && viewCount < maxViews) {
+                void* data = archetype->GetColumn(chunk, column);
+                if (writable) {
+                    archetype->MarkColumnChanged(chunk, column);
+                    if (isTransform) {
+                        // Scripts write the fields in place, so cached matrices can no longer be trusted.
+                        auto* transforms = static_cast<ECS::TransformComponent*>(data);
+                        for (size_t i = 0; i < chunk.entityCount; ++i) {
+                            transforms[i].transform.MarkDirty();
+                        }
+                    }
+                }
+                
+                outViews[viewCount] = CColumnView{
+                    data,
+                    reinterpret_cast<const CEntity*>(chunk.GetEntities()),
+                    static_cast<uint32_t>(typeInfo.size),
+                    static_cast<uint32_t>(chunk.entityCount)
+                };
+            }
+            ++viewCount;
+        }
+    }
+    return viewCount;
+}
+
+bool world_register_chunk_system(void* world, const char* name, const CQueryDesc* query,
+                                 CChunkSystemCallback callback, void* userData) {
+    ECS::World* w = static_cast<ECS::World*>(world);
+    
+    std::vector<ECS::ComponentTypeID> reads;
+    std::vector<ECS::ComponentTypeID> writes;
+    if (!ResolveQueryTypes(query->reads, query->readCount, false, reads) ||
+        !ResolveQueryTypes(query->writes, query->writeCount, true, writes)) {
+        return false;
+    }
+    if (reads.empty() && writes.empty()) {
+        std::cerr << "Script system " << name << " has an empty query" << std::endl;
+        return false;
+    }
+    
+    w->AddSystem(std::make_unique<ScriptChunkSystem>(name, std::move(reads), std::move(writes), callback, userData));
+    return true;
+}
+
+uint64_t transform_component_id() {
+    ECS::ComponentTypeID typeID = ECS::ComponentRegistry::GetTypeID<ECS::TransformComponent>();
+    return ECS::ComponentRegistry::GetTypeInfo(typeID).stableID;
+}
+
+CTransformLayout transform_component_layout() {
+    ECS::TransformComponent tc;
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&tc);
+    
+    return CTransformLayout{
+        static_cast<uint32_t>(sizeof(ECS::TransformComponent)),
+        static_cast<uint32_t>(reinterpret_cast<const uint8_t*>(&tc.GetPosition()) - base),
+        static_cast<uint32_t>(reinterpret_cast<const uint8_t*>(&tc.GetRotation()) - base),
+        static_cast<uint32_t>(reinterpret_cast<const uint8_t*>(&tc.GetScale()) - base)
+    };
+}
+
 }
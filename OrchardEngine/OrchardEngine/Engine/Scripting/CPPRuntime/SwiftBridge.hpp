@@ -15,6 +15,37 @@ struct CTransform {
     float scaleX, scaleY, scaleZ;
 };
 
+struct CColumnView {
+    void* data;
+    const CEntity* entities;
+    uint32_t stride;
+    uint32_t count;
+};
+
+struct CTransformLayout {
+    uint32_t stride;
+    uint32_t positionOffset;
+    uint32_t rotationOffset;
+    uint32_t scaleOffset;
+};
+
+struct CQueryDesc {
+    const uint64_t* reads;
+    uint32_t readCount;
+    const uint64_t* writes;
+    uint32_t writeCount;
+};
+
+struct CChunkView {
+    const CEntity* entities;
+    void* const* columns;
+    const uint32_t* strides;
+    uint32_t count;
+    uint32_t columnCount;
+};
+
+typedef void (*CChunkSystemCallback)(const CChunkView* chunk, double deltaTime, void* userData);
+
 void* engine_create();
 void engine_destroy(void* engine);
 bool engine_initialize(void* engine, const char* appName, uint32_t width, uint32_t height);
@@ -31,4 +62,14 @@ void world_destroy_entity(void* world, CEntity entity);
 void world_add_transform_component(void* world, CEntity entity, CTransform* transform);
 void world_update(void* world, double deltaTime);
 
+void world_create_entities(void* world, uint32_t count, const CTransform* transforms, CEntity* outEntities);
+void world_destroy_entities(void* world, const CEntity* entities, uint32_t count);
+uint32_t world_set_transforms(void* world, const CEntity* entities, const CTransform* transforms, uint32_t count);
+uint32_t world_get_column_views(void* world, uint64_t componentID, bool writable, CColumnView* outViews, uint32_t maxViews);
+bool world_register_chunk_system(void* world, const char* name, const CQueryDesc* query,
+                                 CChunkSystemCallback callback, void* userData);
+
+uint64_t transform_component_id();
+CTransformLayout transform_component_layout();
+
 }
@@ -52,6 +52,7 @@ import Foundation
 
 @objc public class World: NSObject {
     private var cppWorld: OpaquePointer?
+    private var chunkSystems: [ChunkSystemBox] = []
     
     public override init() {
         super.init()
@@ -86,6 +87,178 @@ import Foundation
         guard let world = cppWorld else { return }
         world_update(world, deltaTime)
     }
+    
+    public func createEntities(count: Int, transforms: [Transform]? = nil) -> [Entity] {
+        guard let world = cppWorld, count > 0 else { return [] }
+        var cEntities = [CEntity](repeating: CEntity(id: 0, version: 0), count: count)
+        cEntities.withUnsafeMutableBufferPointer { entityBuffer in
+            if let transforms = transforms {
+                precondition(transforms.count == count, "One transform per entity is required")
+                let cTransforms = transforms.map { $0.cTransform }
+                cTransforms.withUnsafeBufferPointer { transformBuffer in
+                    world_create_entities(world, UInt32(count), transformBuffer.baseAddress, entityBuffer.baseAddress)
+                }
+            } else {
+                world_create_entities(world, UInt32(count), nil, entityBuffer.baseAddress)
+            }
+        }
+        return cEntities.map { Entity(id: $0.id, version: $0.version) }
+    }
+    
+    public func destroyEntities(_ entities: [Entity]) {
+        guard let world = cppWorld, !entities.isEmpty else { return }
+        let cEntities = entities.map { CEntity(id: $0.id, version: $0.version) }
+        cEntities.withUnsafeBufferPointer { buffer in
+            world_destroy_entities(world, buffer.baseAddress!, UInt32(buffer.count))
+        }
+    }
+    
+    @discardableResult
+    public func setTransforms(_ entities: [Entity], _ transforms: [Transform]) -> Int {
+        guard let world = cppWorld, !entities.isEmpty else { return 0 }
+        precondition(entities.count == transforms.count, "One transform per entity is required")
+        let cEntities = entities.map { CEntity(id: $0.id, version: $0.version) }
+        let cTransforms = transforms.map { $0.cTransform }
+        return cEntities.withUnsafeBufferPointer { entityBuffer in
+            cTransforms.withUnsafeBufferPointer { transformBuffer in
+                Int(world_set_transforms(world, entityBuffer.baseAddress!, transformBuffer.baseAddress!, UInt32(entityBuffer.count)))
+            }
+        }
+    }
+    
+    public func columnViews(componentID: UInt64, writable: Bool) -> [ColumnView] {
+        guard let world = cppWorld else { return [] }
+        let viewCount = Int(world_get_column_views(world, componentID, false, nil, 0))
+        guard viewCount > 0 else { return [] }
+        
+        var views = [CColumnView](repeating: CColumnView(data: nil, entities: nil, stride: 0, count: 0), count: viewCount)
+        let filled = views.withUnsafeMutableBufferPointer { buffer in
+            Int(world_get_column_views(world, componentID, writable, buffer.baseAddress, UInt32(buffer.count)))
+        }
+        return views.prefix(min(filled, viewCount)).map { ColumnView($0) }
+    }
+    
+    @discardableResult
+    public func registerChunkSystem(name: String, reads: [UInt64] = [], writes: [UInt64] = [],
+                                    _ body: @escaping (ChunkView, Double) -> Void) -> Bool {
+        guard let world = cppWorld else { return false }
+        let box = ChunkSystemBox(body)
+        let userData = Unmanaged.passUnretained(box).toOpaque()
+        
+        let registered = reads.withUnsafeBufferPointer { readBuffer in
+            writes.withUnsafeBufferPointer { writeBuffer in
+                var query = CQueryDesc(reads: readBuffer.baseAddress, readCount: UInt32(readBuffer.count),
+                                       writes: writeBuffer.baseAddress, writeCount: UInt32(writeBuffer.count))
+                return name.withCString { namePtr in
+                    world_register_chunk_system(world, namePtr, &query, chunkSystemTrampoline, userData)
+                }
+            }
+        }
+        if registered {
+            chunkSystems.append(box)
+        }
+        return registered
+    }
+    
+    public func transformViews(writable: Bool) -> [TransformColumnView] {
+        let layout = TransformColumnView.layout
+        return columnViews(componentID: transform_component_id(), writable: writable).map {
+            TransformColumnView(column: $0, layout: layout)
+        }
+    }
+}
+
+public struct ColumnView {
+    public let data: UnsafeMutableRawPointer
+    public let stride: Int
+    public let count: Int
+    private let entities: UnsafePointer<CEntity>
+    
+    init(_ view: CColumnView) {
+        data = view.data!
+        entities = view.entities!
+        stride = Int(view.stride)
+        count = Int(view.count)
+    }
+    
+    public func entity(at index: Int) -> Entity {
+        let cEntity = entities[index]
+        return Entity(id: cEntity.id, version: cEntity.version)
+    }
+    
+    public func pointer<T>(at index: Int, offset: Int = 0, as type: T.Type) -> UnsafeMutablePointer<T> {
+        precondition(index >= 0 && index < count)
+        return (data + index * stride + offset).assumingMemoryBound(to: type)
+    }
+}
+
+public struct ChunkView {
+    private let view: UnsafePointer<CChunkView>
+    
+    init(_ view: UnsafePointer<CChunkView>) {
+        self.view = view
+    }
+    
+    public var count: Int { Int(view.pointee.count) }
+    public var columnCount: Int { Int(view.pointee.columnCount) }
+    
+    public func entity(at index: Int) -> Entity {
+        let cEntity = view.pointee.entities![index]
+        return Entity(id: cEntity.id, version: cEntity.version)
+    }
+    
+    public func column(_ column: Int) -> UnsafeMutableRawPointer? {
+        precondition(column >= 0 && column < columnCount)
+        return view.pointee.columns![column]
+    }
+    
+    public func element<T>(_ column: Int, at index: Int, offset: Int = 0, as type: T.Type) -> UnsafeMutablePointer<T> {
+        precondition(index >= 0 && index < count)
+        return (self.column(column)! + index * stride(of: column) + offset).assumingMemoryBound(to: type)
+    }
+    
+    public func stride(of column: Int) -> Int {
+        return Int(view.pointee.strides![column])
+    }
+}
+
+final class ChunkSystemBox {
+    let body: (ChunkView, Double) -> Void
+    
+    init(_ body: @escaping (ChunkView, Double) -> Void) {
+        self.body = body
+    }
+}
+
+private let chunkSystemTrampoline: @convention(c) (UnsafePointer<CChunkView>?, Double, UnsafeMutableRawPointer?) -> Void = { chunk, deltaTime, userData in
+    guard let chunk = chunk, let userData = userData else { return }
+    let box = Unmanaged<ChunkSystemBox>.fromOpaque(userData).takeUnretainedValue()
+    box.body(ChunkView(chunk), deltaTime)
+}
+
+public struct TransformColumnView {
+    static let layout = transform_component_layout()
+    
+    public let column: ColumnView
+    let layout: CTransformLayout
+    
+    public var count: Int { column.count }
+    
+    public func entity(at index: Int) -> Entity {
+        return column.entity(at: index)
+    }
+    
+    public func position(at index: Int) -> UnsafeMutablePointer<SIMD3<Float>> {
+        return column.pointer(at: index, offset: Int(layout.positionOffset), as: SIMD3<Float>.self)
+    }
+    
+    public func rotation(at index: Int) -> UnsafeMutablePointer<SIMD4<Float>> {
+        return column.pointer(at: index, offset: Int(layout.rotationOffset), as: SIMD4<Float>.self)
+    }
+    
+    public func scale(at index: Int) -> UnsafeMutablePointer<SIMD3<Float>> {
+        return column.pointer(at: index, offset: Int(layout.scaleOffset), as: SIMD3<Float>.self)
+    }
 }
 
 public struct Entity: Equatable {
@@ -114,12 +287,16 @@ public struct Transform: Component {
         self.scale = scale
     }
     
-    public func addToWorld(_ world: OpaquePointer, entity: CEntity) {
-        var cTransform = CTransform(
+    var cTransform: CTransform {
+        return CTransform(
             positionX: position.x, positionY: position.y, positionZ: position.z,
             rotationX: rotation.x, rotationY: rotation.y, rotationZ: rotation.z, rotationW: rotation.w,
             scaleX: scale.x, scaleY: scale.y, scaleZ: scale.z
         )
+    }
+    
+    public func addToWorld(_ world: OpaquePointer, entity: CEntity) {
+        var cTransform = self.cTransform
         world_add_transform_component(world, entity, &cTransform)
     }
 }
@@ -145,6 +322,35 @@ struct CTransform {
     var scaleX, scaleY, scaleZ: Float
 }
 
+struct CColumnView {
+    var data: UnsafeMutableRawPointer?
+    var entities: UnsafePointer<CEntity>?
+    var stride: UInt32
+    var count: UInt32
+}
+
+struct CQueryDesc {
+    var reads: UnsafePointer<UInt64>?
+    var readCount: UInt32
+    var writes: UnsafePointer<UInt64>?
+    var writeCount: UInt32
+}
+
+struct CChunkView {
+    var entities: UnsafePointer<CEntity>?
+    var columns: UnsafePointer<UnsafeMutableRawPointer?>?
+    var strides: UnsafePointer<UInt32>?
+    var count: UInt32
+    var columnCount: UInt32
+}
+
+struct CTransformLayout {
+    var stride: UInt32
+    var positionOffset: UInt32
+    var rotationOffset: UInt32
+    var scaleOffset: UInt32
+}
+
 @_silgen_name("engine_create")
 func engine_create() -> OpaquePointer
 
@@ -186,3 +392,26 @@ func world_add_transform_component(_ world: OpaquePointer, _ entity: CEntity, _
 
 @_silgen_name("world_update")
 func world_update(_ world: OpaquePointer, _ deltaTime: Double)
+
+@_silgen_name("world_create_entities")
+func world_create_entities(_ world: OpaquePointer, _ count: UInt32, _ transforms: UnsafePointer<CTransform>?, _ outEntities: UnsafeMutablePointer<CEntity>?)
+
+@_silgen_name("world_destroy_entities")
+func world_destroy_entities(_ world: OpaquePointer, _ entities: UnsafePointer<CEntity>, _ count: UInt32)
+
+@_silgen_name("world_set_transforms")
+func world_set_transforms(_ world: OpaquePointer, _ entities: UnsafePointer<CEntity>, _ transforms: UnsafePointer<CTransform>, _ count: UInt32) -> UInt32
+
+@_silgen_name("world_get_column_views")
+func world_get_column_views(_ world: OpaquePointer, _ componentID: UInt64, _ writable: Bool, _ outViews: UnsafeMutablePointer<CColumnView>?, _ maxViews: UInt32) -> UInt32
+
+@_silgen_name("world_register_chunk_system")
+func world_register_chunk_system(_ world: OpaquePointer, _ name: UnsafePointer<CChar>, _ query: UnsafePointer<CQueryDesc>,
+                                 _ callback: @convention(c) (UnsafePointer<CChunkView>?, Double, UnsafeMutableRawPointer?) -> Void,
+                                 _ userData: UnsafeMutableRawPointer?) -> Bool
+
+@_silgen_name("transform_component_id")
+func transform_component_id() -> UInt64
+
+@_silgen_name("transform_component_layout")
+func transform_component_layout() -> CTransformLayout
@@ -0,0 +1,104 @@
+#include "TestCommon.hpp"
+#include "Core/Memory.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace Orchard::Memory;
+
+namespace {
+
+constexpr size_t VALUE_COUNT = 4000;
+
+uint32_t* FillFrame(uint32_t seed) {
+    uint32_t* values = FrameAllocator::AllocateArray<uint32_t>(VALUE_COUNT);
+    for (size_t i = 0; i < VALUE_COUNT; ++i) {
+        values[i] = seed + static_cast<uint32_t>(i);
+    }
+    return values;
+}
+
+bool IsIntact(const uint32_t* values, uint32_t seed) {
+    for (size_t i = 0; i < VALUE_COUNT; ++i) {
+        if (values[i] != seed + static_cast<uint32_t>(i)) return false;
+    }
+    return true;
+}
+
+void TestFrameDataSurvivesNextFrame() {
+    MemoryArena* arena = &FrameAllocator::GetThreadArena();
+    uint32_t* previous = FillFrame(1000);
+    
+    FrameAllocator::BeginFrame();
+    MemoryArena* nextArena = &FrameAllocator::GetThreadArena();
+    ORCHARD_CHECK(nextArena != arena);
+    uint32_t* current = FillFrame(2000);
+    ORCHARD_CHECK(IsIntact(previous, 1000));
+    ORCHARD_CHECK(IsIntact(current, 2000));
+    
+    FrameAllocator::BeginFrame();
+    ORCHARD_CHECK(&FrameAllocator::GetThreadArena() == arena);
+    ORCHARD_CHECK(arena->GetUsed() == 0);
+    uint32_t* reused = FillFrame(3000);
+    ORCHARD_CHECK(reused == previous);
+    ORCHARD_CHECK(IsIntact(current, 2000));
+}
+
+void TestThreadsUseSeparateArenas() {
+    constexpr uint32_t THREAD_COUNT = 4;
+    constexpr uint32_t FRAME_COUNT = 20;
+    
+    uint64_t firstFrame = FrameAllocator::GetFrameIndex();
+    std::atomic<uint32_t> finished{0};
+    std::atomic<bool> corrupted{false};
+    std::vector<MemoryArena*> arenas(THREAD_COUNT * 2);
+    
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREAD_COUNT; ++t) {
+        threads.emplace_back([&, t]() {
+            uint32_t* previous = nullptr;
+            for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame) {
+                while (FrameAllocator::GetFrameIndex() != firstFrame + frame) {
+                    std::this_thread::yield();
+                }
+                if (frame < 2) {
+                    arenas[t * 2 + ((firstFrame + frame) & 1)] = &FrameAllocator::GetThreadArena();
+                }
+                
+                uint32_t* current = FillFrame(t * 100000 + frame * 1000);
+                if (previous && !IsIntact(previous, t * 100000 + (frame - 1) * 1000)) corrupted = true;
+                previous = current;
+                finished.fetch_add(1);
+            }
+        });
+    }
+    
+    for (uint32_t frame = 0; frame < FRAME_COUNT; ++frame) {
+        while (finished.load() != THREAD_COUNT * (frame + 1)) {
+            std::this_thread::yield();
+        }
+        FrameAllocator::BeginFrame();
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    ORCHARD_CHECK(!corrupted);
+    for (size_t i = 0; i < arenas.size(); ++i) {
+        ORCHARD_CHECK(arenas[i] != nullptr);
+        for (size_t j = i + 1; j < arenas.size(); ++j) {
+            ORCHARD_CHECK(arenas[i] != arenas[j]);
+        }
+    }
+    ORCHARD_CHECK(arenas[0] != &FrameAllocator::GetThreadArena());
+}
+
+}
+
+int main() {
+    FrameAllocator::SetBlockSize(4 * KB);
+    TestFrameDataSurvivesNextFrame();
+    TestThreadsUseSeparateArenas();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+#include "TestCommon.hpp"
+#include "Core/Memory.hpp"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace Orchard::Memory;
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 4 * KB;
+
+bool IsAligned(const void* pointer, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(pointer) % alignment == 0;
+}
+
+bool IsFilled(const void* pointer, size_t size, uint8_t value) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(pointer);
+    for (size_t i = 0; i < size; ++i) {
+        if (bytes[i] != value) return false;
+    }
+    return true;
+}
+
+void TestOverflowChainsBlocks() {
+    MemoryArena arena(BLOCK_SIZE);
+    ORCHARD_CHECK(arena.GetBlockCount() == 1);
+    ORCHARD_CHECK(arena.GetSize() == BLOCK_SIZE);
+    
+    std::vector<void*> allocations;
+    for (uint8_t i = 0; i < 20; ++i) {
+        void* allocation = arena.Allocate(1000, 32);
+        ORCHARD_CHECK(allocation && IsAligned(allocation, 32));
+        std::memset(allocation, i, 1000);
+        allocations.push_back(allocation);
+    }
+    ORCHARD_CHECK(arena.GetBlockCount() > 1);
+    ORCHARD_CHECK(arena.GetUsed() >= 20 * 1000);
+    
+    size_t blocks = arena.GetBlockCount();
+    void* large = arena.Allocate(64 * KB, 256);
+    ORCHARD_CHECK(large && IsAligned(large, 256));
+    std::memset(large, 0xFF, 64 * KB);
+    ORCHARD_CHECK(arena.GetBlockCount() == blocks + 1);
+    ORCHARD_CHECK(arena.GetSize() >= (blocks - 1) * BLOCK_SIZE + 64 * KB);
+    ORCHARD_CHECK(arena.GetUsed() >= 20 * 1000 + 64 * KB);
+    ORCHARD_CHECK(arena.GetPeakUsed() == arena.GetUsed());
+    
+    for (uint8_t i = 0; i < 20; ++i) {
+        ORCHARD_CHECK(IsFilled(allocations[i], 1000, i));
+    }
+}
+
+void TestRewindAcrossBlocks() {
+    MemoryArena arena(BLOCK_SIZE);
+    void* before = arena.Allocate(1000);
+    std::memset(before, 0x5A, 1000);
+    
+    MemoryArena::Marker marker = arena.GetMarker();
+    void* first = arena.Allocate(1000);
+    for (int i = 0; i < 30; ++i) {
+        arena.Allocate(1000);
+    }
+    ORCHARD_CHECK(arena.GetBlockCount() > 5);
+    
+    size_t capacity = arena.GetSize();
+    arena.RewindTo(marker);
+    ORCHARD_CHECK(arena.GetUsed() == marker.used);
+    ORCHARD_CHECK(arena.Allocate(1000) == first);
+    for (int i = 0; i < 30; ++i) {
+        arena.Allocate(1000);
+    }
+    ORCHARD_CHECK(arena.GetSize() == capacity);
+    
+    arena.RewindTo(marker);
+    {
+        ArenaScope scope(arena);
+        for (int i = 0; i < 10; ++i) {
+            arena.Allocate(1000);
+        }
+        ORCHARD_CHECK(arena.GetUsed() > marker.used);
+    }
+    ORCHARD_CHECK(arena.GetUsed() == marker.used);
+    ORCHARD_CHECK(arena.Allocate(1000) == first);
+    ORCHARD_CHECK(IsFilled(before, 1000, 0x5A));
+}
+
+void TestReleaseSurplus() {
+    MemoryArena arena(BLOCK_SIZE);
+    for (int i = 0; i < 20; ++i) {
+        arena.Allocate(1000);
+    }
+    size_t blocks = arena.GetBlockCount();
+    
+    arena.ReleaseSurplus();
+    ORCHARD_CHECK(arena.GetBlockCount() == blocks);
+    
+    arena.Reset();
+    ORCHARD_CHECK(arena.GetUsed() == 0);
+    ORCHARD_CHECK(arena.GetPeakUsed() >= 20 * 1000);
+    arena.ReleaseSurplus(2 * BLOCK_SIZE);
+    ORCHARD_CHECK(arena.GetBlockCount() == 2);
+    ORCHARD_CHECK(arena.GetSize() == 2 * BLOCK_SIZE);
+    
+    arena.ReleaseSurplus();
+    ORCHARD_CHECK(arena.GetBlockCount() == 1);
+    ORCHARD_CHECK(arena.GetSize() == BLOCK_SIZE);
+    
+    void* allocation = arena.Allocate(1000);
+    ORCHARD_CHECK(allocation != nullptr);
+    ORCHARD_CHECK(arena.GetUsed() >= 1000);
+}
+
+void TestNewBlocksAreZeroed() {
+    MemoryArena arena(BLOCK_SIZE);
+    void* first = arena.Allocate(BLOCK_SIZE);
+    ORCHARD_CHECK(IsFilled(first, BLOCK_SIZE, 0));
+    std::memset(first, 0xAB, BLOCK_SIZE);
+    
+    void* overflow = arena.Allocate(3 * BLOCK_SIZE);
+    ORCHARD_CHECK(arena.GetBlockCount() == 2);
+    ORCHARD_CHECK(IsFilled(overflow, 3 * BLOCK_SIZE, 0));
+    std::memset(overflow, 0xCD, 3 * BLOCK_SIZE);
+    
+    arena.Clear();
+    ORCHARD_CHECK(arena.GetUsed() == 0);
+    ORCHARD_CHECK(arena.Allocate(BLOCK_SIZE) == first);
+    ORCHARD_CHECK(IsFilled(first, BLOCK_SIZE, 0));
+    ORCHARD_CHECK(arena.Allocate(3 * BLOCK_SIZE) == overflow);
+    ORCHARD_CHECK(IsFilled(overflow, 3 * BLOCK_SIZE, 0));
+}
+
+}
+
+int main() {
+    TestOverflowChainsBlocks();
+    TestRewindAcrossBlocks();
+    TestReleaseSurplus();
+    TestNewBlocksAreZeroed();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#include "TestCommon.hpp"
+#include "Core/Memory.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace Orchard::Memory;
+
+namespace {
+
+void TestConcurrentAllocateAndFree() {
+    constexpr size_t CAPACITY = 4096;
+    PoolAllocator pool(24, CAPACITY);
+    
+    std::vector<std::thread> threads;
+    std::atomic<bool> corrupted{false};
+    for (uint64_t t = 0; t < 8; ++t) {
+        threads.emplace_back([&pool, &corrupted, t]() {
+            std::vector<uint64_t*> held;
+            for (uint64_t i = 0; i < 20000; ++i) {
+                if (held.size() < 200 && i % 3 != 2) {
+                    if (uint64_t* element = static_cast<uint64_t*>(pool.Allocate())) {
+                        element[0] = t;
+                        element[1] = i;
+                        element[2] = ~t;
+                        held.push_back(element);
+                    }
+                } else if (!held.empty()) {
+                    uint64_t* element = held.back();
+                    held.pop_back();
+                    if (element[0] != t || element[2] != ~t) corrupted = true;
+                    pool.Deallocate(element);
+                }
+            }
+            for (uint64_t* element : held) {
+                if (element[0] != t || element[2] != ~t) corrupted = true;
+                pool.Deallocate(element);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    ORCHARD_CHECK(!corrupted);
+    ORCHARD_CHECK(pool.GetUsedCount() == 0);
+    
+    std::vector<void*> elements;
+    while (void* element = pool.Allocate()) {
+        elements.push_back(element);
+    }
+    ORCHARD_CHECK(elements.size() == CAPACITY);
+    for (void* element : elements) {
+        pool.Deallocate(element);
+    }
+    ORCHARD_CHECK(pool.GetUsedCount() == 0);
+}
+
+void TestAllocateTakesFromOtherThreadsMagazines() {
+    constexpr size_t CAPACITY = 64;
+    PoolAllocator pool(16, CAPACITY);
+    
+    std::atomic<int> stage{0};
+    std::thread owner([&]() {
+        std::vector<void*> elements;
+        while (void* element = pool.Allocate()) {
+            elements.push_back(element);
+        }
+        for (void* element : elements) {
+            pool.Deallocate(element);
+        }
+        stage = 1;
+        while (stage != 2) {
+            std::this_thread::yield();
+        }
+    });
+    
+    while (stage != 1) {
+        std::this_thread::yield();
+    }
+    
+    std::vector<void*> elements;
+    while (void* element = pool.Allocate()) {
+        elements.push_back(element);
+    }
+    stage = 2;
+    owner.join();
+    
+    ORCHARD_CHECK(elements.size() == CAPACITY);
+    ORCHARD_CHECK(pool.GetUsedCount() == CAPACITY);
+    for (void* element : elements) {
+        pool.Deallocate(element);
+    }
+    ORCHARD_CHECK(pool.GetUsedCount() == 0);
+}
+
+void TestZeroSizedElements() {
+    PoolAllocator pool(0, 8);
+    ORCHARD_CHECK(pool.GetElementSize() >= sizeof(void*));
+    
+    std::vector<void*> elements;
+    while (void* element = pool.Allocate()) {
+        elements.push_back(element);
+    }
+    ORCHARD_CHECK(elements.size() == 8);
+    for (size_t i = 1; i < elements.size(); ++i) {
+        ORCHARD_CHECK(elements[i] != elements[i - 1]);
+    }
+    for (void* element : elements) {
+        pool.Deallocate(element);
+    }
+}
+
+}
+
+int main() {
+    TestConcurrentAllocateAndFree();
+    TestAllocateTakesFromOtherThreadsMagazines();
+    TestZeroSizedElements();
+    return EXIT_SUCCESS;
+}
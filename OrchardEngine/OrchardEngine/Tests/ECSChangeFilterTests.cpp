@@ -0,0 +1,136 @@
+#include "TestCommon.hpp"
+#include "ECS/World.hpp"
+#include <memory>
+#include <vector>
+
+using namespace Orchard::ECS;
+
+namespace {
+
+struct Position { float x; };
+struct Velocity { float x; };
+
+class ChangedReader : public System {
+public:
+    ChangedReader() { Reads<Position>(); }
+    
+    void OnUpdate(World* world, double) override {
+        seen = 0;
+        world->GetQuery<Changed<const Position>>().ForEach(GetLastRunVersion(), [this](Entity, const Position&) {
+            ++seen;
+        });
+    }
+    
+    size_t seen = 0;
+};
+
+class SelfClamp : public System {
+public:
+    SelfClamp() { Writes<Position>(); }
+    
+    void OnUpdate(World* world, double) override {
+        processed = 0;
+        world->GetQuery<Changed<const Position>, Position>().ForEach(GetLastRunVersion(),
+            [this](Entity, const Position&, Position& position) {
+                if (position.x > 10.0f) position.x = 10.0f;
+                ++processed;
+            });
+    }
+    
+    size_t processed = 0;
+};
+
+void TestReaderSeesEachChangeOnce() {
+    World world;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 3000; ++i) {
+        Entity entity = world.CreateEntity();
+        world.AddComponent(entity, Position{ 0.0f });
+        if (i < 1000) world.AddComponent(entity, Velocity{ 1.0f });
+        entities.push_back(entity);
+    }
+    
+    auto reader = std::make_unique<ChangedReader>();
+    ChangedReader* view = reader.get();
+    world.AddSystem(std::move(reader));
+    
+    world.Update(0.0);
+    ORCHARD_CHECK(view->seen == 3000);
+    world.Update(0.0);
+    ORCHARD_CHECK(view->seen == 0);
+    
+    world.GetQuery<Position, const Velocity>().ForEach([](Entity, Position& position, const Velocity& velocity) {
+        position.x += velocity.x;
+    });
+    world.Update(0.0);
+    ORCHARD_CHECK(view->seen == 1000);
+    world.Update(0.0);
+    ORCHARD_CHECK(view->seen == 0);
+    
+    const World& constWorld = world;
+    (void)constWorld.GetComponent<Position>(entities[2500]);
+    world.Update(0.0);
+    ORCHARD_CHECK(view->seen == 0);
+}
+
+void TestSystemIgnoresItsOwnWrites() {
+    World world;
+    for (int i = 0; i < 2000; ++i) {
+        Entity entity = world.CreateEntity();
+        world.AddComponent(entity, Position{ static_cast<float>(i) });
+    }
+    
+    auto clamp = std::make_unique<SelfClamp>();
+    SelfClamp* writer = clamp.get();
+    auto reader = std::make_unique<ChangedReader>();
+    ChangedReader* observer = reader.get();
+    world.AddSystem(std::move(clamp));
+    world.AddSystem(std::move(reader));
+    
+    world.Update(0.0);
+    ORCHARD_CHECK(writer->processed == 2000);
+    ORCHARD_CHECK(observer->seen == 2000);
+    
+    world.Update(0.0);
+    ORCHARD_CHECK(writer->processed == 0);
+    ORCHARD_CHECK(observer->seen == 0);
+    
+    Entity entity = world.CreateEntity();
+    world.AddComponent(entity, Position{ 50.0f });
+    world.Update(0.0);
+    ORCHARD_CHECK(writer->processed > 0 && writer->processed < 2001);
+    const World& constWorld = world;
+    ORCHARD_CHECK(constWorld.GetComponent<Position>(entity)->x == 10.0f);
+    world.Update(0.0);
+    ORCHARD_CHECK(writer->processed == 0);
+}
+
+void TestChangeFilterDoesNotStampColumn() {
+    World world;
+    Entity entity = world.CreateEntity();
+    world.AddComponent(entity, Position{ 1.0f });
+    
+    uint32_t since = world.AdvanceChangeVersion();
+    world.GetQuery<Changed<Position>>().ForEach(0, [](Entity, const Position&) {});
+    ORCHARD_CHECK(!world.HasChanged<Position>(entity, since));
+    
+    world.GetQuery<Position>().ForEach([](Entity, Position& position) { position.x = 2.0f; });
+    ORCHARD_CHECK(world.HasChanged<Position>(entity, since));
+}
+
+void TestVersionComparisonWrapsAround() {
+    ORCHARD_CHECK(Archetype::IsNewerVersion(1, 0xFFFFFFFFu));
+    ORCHARD_CHECK(Archetype::IsNewerVersion(5, 3));
+    ORCHARD_CHECK(!Archetype::IsNewerVersion(3, 3));
+    ORCHARD_CHECK(!Archetype::IsNewerVersion(0xFFFFFFFFu, 1));
+}
+
+}
+
+int main() {
+    TestReaderSeesEachChangeOnce();
+    TestSystemIgnoresItsOwnWrites();
+    TestChangeFilterDoesNotStampColumn();
+    TestVersionComparisonWrapsAround();
+    return EXIT_SUCCESS;
+}
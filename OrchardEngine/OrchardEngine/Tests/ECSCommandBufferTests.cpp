@@ -0,0 +1,92 @@
+#include "TestCommon.hpp"
+#include "ECS/World.hpp"
+#include <string>
+#include <thread>
+
+using namespace Orchard::ECS;
+
+namespace {
+
+struct Position { float x; };
+struct Name { std::string value; };
+
+EntityCommandBuffer& GetBufferOnOtherThread(World& world) {
+    EntityCommandBuffer* buffer = nullptr;
+    std::thread([&]() { buffer = &world.GetCommandBuffer(); }).join();
+    return *buffer;
+}
+
+void TestPlaceholderResolvesAcrossBuffers() {
+    World world;
+    EntityCommandBuffer& first = world.GetCommandBuffer();
+    EntityCommandBuffer& second = GetBufferOnOtherThread(world);
+    ORCHARD_CHECK(&first != &second);
+    
+    Entity a = first.CreateEntity();
+    Entity b = second.CreateEntity();
+    second.AddComponent(a, Position{ 1.0f });
+    first.AddComponent(b, Name{ std::string(64, 'b') });
+    first.AddComponent(a, Name{ std::string(64, 'a') });
+    
+    world.PlaybackCommands();
+    
+    const World& constWorld = world;
+    size_t count = 0;
+    world.GetQuery<const Position, const Name>().ForEach([&](Entity, const Position& position, const Name& name) {
+        ORCHARD_CHECK(position.x == 1.0f);
+        ORCHARD_CHECK(name.value == std::string(64, 'a'));
+        ++count;
+    });
+    ORCHARD_CHECK(count == 1);
+    
+    count = 0;
+    world.GetQuery<const Name>().ForEach([&](Entity entity, const Name&) {
+        if (!constWorld.HasComponent<Position>(entity)) {
+            ORCHARD_CHECK(constWorld.GetComponent<Name>(entity)->value == std::string(64, 'b'));
+        }
+        ++count;
+    });
+    ORCHARD_CHECK(count == 2);
+    ORCHARD_CHECK(first.IsEmpty() && second.IsEmpty());
+}
+
+void TestCommandsApplyInRecordedOrder() {
+    World world;
+    Entity kept = world.CreateEntity();
+    Entity removed = world.CreateEntity();
+    Entity destroyed = world.CreateEntity();
+    world.AddComponent(removed, Position{ 0.0f });
+    
+    EntityCommandBuffer& buffer = world.GetCommandBuffer();
+    buffer.AddComponent(kept, Name{ "first" });
+    buffer.AddComponent(kept, Name{ "second" });
+    buffer.RemoveComponent<Position>(removed);
+    buffer.AddComponent(removed, Position{ 2.0f });
+    buffer.RemoveComponent<Position>(removed);
+    buffer.AddComponent(destroyed, Name{ "gone" });
+    buffer.DestroyEntity(destroyed);
+    
+    Entity created = buffer.CreateEntity();
+    buffer.AddComponent(created, Position{ 3.0f });
+    buffer.DestroyEntity(created);
+    
+    world.PlaybackCommands();
+    
+    const World& constWorld = world;
+    ORCHARD_CHECK(constWorld.GetComponent<Name>(kept)->value == "second");
+    ORCHARD_CHECK(world.IsEntityValid(removed));
+    ORCHARD_CHECK(!constWorld.HasComponent<Position>(removed));
+    ORCHARD_CHECK(!world.IsEntityValid(destroyed));
+    
+    size_t positions = 0;
+    world.GetQuery<const Position>().ForEach([&](Entity, const Position&) { ++positions; });
+    ORCHARD_CHECK(positions == 0);
+}
+
+}
+
+int main() {
+    TestPlaceholderResolvesAcrossBuffers();
+    TestCommandsApplyInRecordedOrder();
+    return EXIT_SUCCESS;
+}
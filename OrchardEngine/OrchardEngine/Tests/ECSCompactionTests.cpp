@@ -0,0 +1,132 @@
+#include "TestCommon.hpp"
+#include "ECS/World.hpp"
+#include <vector>
+
+using namespace Orchard::ECS;
+
+namespace {
+
+struct Position { float x; };
+
+std::vector<Entity> Populate(World& world, size_t count) {
+    std::vector<Entity> entities;
+    for (size_t i = 0; i < count; ++i) {
+        Entity entity = world.CreateEntity();
+        world.AddComponent(entity, Position{ static_cast<float>(entity.id) });
+        entities.push_back(entity);
+    }
+    return entities;
+}
+
+const Archetype& GetPositionArchetype(const World& world) {
+    for (const Archetype* archetype : world.GetArchetypes()) {
+        if (archetype->HasComponent(ComponentRegistry::GetTypeID<Position>())) {
+            return *archetype;
+        }
+    }
+    ORCHARD_CHECK(false);
+    std::abort();
+}
+
+void TestCompactionRemapsEntities() {
+    World world;
+    std::vector<Entity> entities = Populate(world, 1);
+    size_t perChunk = GetPositionArchetype(world).GetEntitiesPerChunk();
+    std::vector<Entity> more = Populate(world, perChunk * 4 - 1);
+    entities.insert(entities.end(), more.begin(), more.end());
+    
+    std::vector<Entity> alive;
+    for (size_t i = 0; i < entities.size(); ++i) {
+        if (i < perChunk || i % 3 == 0) {
+            world.DestroyEntity(entities[i]);
+        } else {
+            alive.push_back(entities[i]);
+        }
+    }
+    
+    ORCHARD_CHECK(world.Compact(1.0e6));
+    
+    const World& constWorld = world;
+    const Archetype& archetype = GetPositionArchetype(world);
+    size_t populatedChunks = 0;
+    for (size_t c = 0; c < archetype.GetChunkCount(); ++c) {
+        if (archetype.GetChunk(c).entityCount > 0) ++populatedChunks;
+    }
+    ORCHARD_CHECK(populatedChunks == (alive.size() + perChunk - 1) / perChunk);
+    
+    for (Entity entity : alive) {
+        ORCHARD_CHECK(world.IsEntityValid(entity));
+        ORCHARD_CHECK(constWorld.GetComponent<Position>(entity)->x == static_cast<float>(entity.id));
+    }
+    
+    size_t visited = 0;
+    world.GetQuery<const Position>().ForEach([&](Entity entity, const Position& position) {
+        ORCHARD_CHECK(position.x == static_cast<float>(entity.id));
+        ++visited;
+    });
+    ORCHARD_CHECK(visited == alive.size());
+}
+
+void TestMovedChunksAreMarkedChanged() {
+    World world;
+    std::vector<Entity> entities = Populate(world, 1);
+    size_t perChunk = GetPositionArchetype(world).GetEntitiesPerChunk();
+    std::vector<Entity> more = Populate(world, perChunk * 3 - 1);
+    entities.insert(entities.end(), more.begin(), more.end());
+    
+    auto before = world.CaptureSnapshot();
+    uint32_t since = world.AdvanceChangeVersion();
+    for (size_t i = 0; i < perChunk; ++i) {
+        world.DestroyEntity(entities[i]);
+    }
+    ORCHARD_CHECK(world.Compact(1.0e6));
+    
+    Entity moved = entities.back();
+    const Archetype::Chunk& first = GetPositionArchetype(world).GetChunk(0);
+    ORCHARD_CHECK(first.entityCount == perChunk && first.GetEntities()[perChunk - 1].id == moved.id);
+    ORCHARD_CHECK(world.HasChanged<Position>(moved, since));
+    
+    auto after = world.CaptureSnapshot();
+    size_t visited = 0;
+    after->ForEach<Position>([&](Entity entity, const Position& position) {
+        ORCHARD_CHECK(world.IsEntityValid(entity));
+        ORCHARD_CHECK(position.x == static_cast<float>(entity.id));
+        ++visited;
+    });
+    ORCHARD_CHECK(visited == perChunk * 2);
+    ORCHARD_CHECK(before->GetEntityCount() == perChunk * 3);
+}
+
+void TestCompactionReturnsEmptySlabs() {
+    World world;
+    std::vector<Entity> entities = Populate(world, 1);
+    size_t perChunk = GetPositionArchetype(world).GetEntitiesPerChunk();
+    std::vector<Entity> more = Populate(world, perChunk * CHUNKS_PER_SLAB * 3);
+    entities.insert(entities.end(), more.begin(), more.end());
+    
+    size_t slabsBefore = world.GetChunkPoolStats().slabCount;
+    ORCHARD_CHECK(slabsBefore >= 3);
+    
+    for (size_t i = perChunk; i < entities.size(); ++i) {
+        world.DestroyEntity(entities[i]);
+    }
+    ORCHARD_CHECK(world.Compact(1.0e6));
+    
+    ChunkPoolStats stats = world.GetChunkPoolStats();
+    ORCHARD_CHECK(stats.slabCount == 1);
+    ORCHARD_CHECK(stats.usedChunks == 1);
+    
+    const World& constWorld = world;
+    for (size_t i = 0; i < perChunk; ++i) {
+        ORCHARD_CHECK(constWorld.GetComponent<Position>(entities[i])->x == static_cast<float>(entities[i].id));
+    }
+}
+
+}
+
+int main() {
+    TestCompactionRemapsEntities();
+    TestMovedChunksAreMarkedChanged();
+    TestCompactionReturnsEmptySlabs();
+    return EXIT_SUCCESS;
+}
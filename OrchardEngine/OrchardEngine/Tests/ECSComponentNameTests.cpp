@@ -0,0 +1,49 @@
+#include "TestCommon.hpp"
+#include "ECS/Component.hpp"
+#include "ECS/Components/TransformComponent.hpp"
+#include <string_view>
+
+using namespace Orchard::ECS;
+
+namespace Gameplay {
+
+struct Health { float value; };
+
+template<typename T>
+struct Buffer { T value; };
+
+struct Renamed {
+    static constexpr std::string_view ComponentName = "Gameplay::Armor";
+    float value;
+};
+
+}
+
+namespace {
+
+void TestQualifiedNames() {
+    ORCHARD_CHECK(GetComponentName<Gameplay::Health>() == "Gameplay::Health");
+    ORCHARD_CHECK(GetComponentName<Gameplay::Buffer<Gameplay::Health>>() == "Gameplay::Buffer<Gameplay::Health>");
+    
+    std::string_view arrayName = GetComponentName<Gameplay::Buffer<int[4]>>();
+    ORCHARD_CHECK(arrayName.substr(0, 17) == "Gameplay::Buffer<");
+    ORCHARD_CHECK(arrayName.substr(arrayName.size() - 3) == "4]>");
+    ORCHARD_CHECK(GetStableTypeID<Gameplay::Buffer<int[4]>>() != GetStableTypeID<Gameplay::Buffer<int[8]>>());
+}
+
+void TestDeclaredNames() {
+    ORCHARD_CHECK(GetComponentName<Gameplay::Renamed>() == "Gameplay::Armor");
+    ORCHARD_CHECK(GetStableTypeID<Gameplay::Renamed>() == Detail::HashName("Gameplay::Armor"));
+    ORCHARD_CHECK(GetComponentName<TransformComponent>() == "Orchard::ECS::TransformComponent");
+    
+    ORCHARD_CHECK(ComponentRegistry::GetTypeInfo(ComponentRegistry::GetTypeID<Gameplay::Renamed>()).named);
+    ORCHARD_CHECK(!ComponentRegistry::GetTypeInfo(ComponentRegistry::GetTypeID<Gameplay::Health>()).named);
+}
+
+}
+
+int main() {
+    TestQualifiedNames();
+    TestDeclaredNames();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,172 @@
+#include "TestCommon.hpp"
+#include "ECS/World.hpp"
+#include "ECS/WorldSerializer.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+using namespace Orchard::ECS;
+
+namespace {
+
+const char* SNAPSHOT_PATH = "ECSSerializationTests.bin";
+EntityID s_EmptyEntity = NULL_ENTITY;
+
+struct Position {
+    static constexpr std::string_view ComponentName = "Tests::Position";
+    float x, y, z;
+};
+struct Velocity {
+    static constexpr std::string_view ComponentName = "Tests::Velocity";
+    double v;
+};
+struct Enemy {
+    static constexpr std::string_view ComponentName = "Tests::Enemy";
+};
+struct Team : SharedComponent {
+    static constexpr std::string_view ComponentName = "Tests::Team";
+    int id;
+    
+    bool operator==(const Team& other) const { return id == other.id; }
+};
+struct Stun : SparseComponent {
+    static constexpr std::string_view ComponentName = "Tests::Stun";
+    int frames;
+};
+struct Unnamed { int value; };
+
+void PopulateAndSave() {
+    World world;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 5000; ++i) {
+        Entity entity = world.CreateEntity();
+        world.AddComponent(entity, Position{ static_cast<float>(i), 1.0f, 2.0f });
+        if (i % 2) world.AddComponent(entity, Velocity{ static_cast<double>(i) });
+        if (i % 3 == 0) world.AddComponent(entity, Enemy{});
+        world.SetSharedComponent(entity, Team{ {}, i % 4 });
+        if (i % 7 == 0) world.AddComponent(entity, Stun{ {}, i });
+        entities.push_back(entity);
+    }
+    for (int i = 100; i < 200; ++i) {
+        world.DestroyEntity(entities[i]);
+    }
+    s_EmptyEntity = world.CreateEntity().id;
+    
+    ORCHARD_CHECK(WorldSerializer::Save(world, SNAPSHOT_PATH));
+}
+
+void CheckLoaded(World& world) {
+    size_t count = 0;
+    world.ForEach<const Position, const Team>([&](Entity entity, const Position& position, const Team& team) {
+        int i = static_cast<int>(position.x);
+        ORCHARD_CHECK(entity.id == static_cast<EntityID>(i + 1));
+        ORCHARD_CHECK(team.id == i % 4);
+        ORCHARD_CHECK(world.HasComponent<Enemy>(entity) == (i % 3 == 0));
+        ORCHARD_CHECK((world.GetComponent<Velocity>(entity) != nullptr) == (i % 2 == 1));
+        if (i % 2) ORCHARD_CHECK(world.GetComponent<Velocity>(entity)->v == i);
+        ORCHARD_CHECK(world.HasComponent<Stun>(entity) == (i % 7 == 0));
+        if (i % 7 == 0) ORCHARD_CHECK(world.GetComponent<Stun>(entity)->frames == i);
+        ++count;
+    });
+    ORCHARD_CHECK(count == 4900);
+    ORCHARD_CHECK(!world.IsEntityValid(Entity(150, 0)));
+    ORCHARD_CHECK(world.IsEntityValid(Entity(s_EmptyEntity, 0)));
+}
+
+void TestRoundTrip() {
+    World world;
+    ORCHARD_CHECK(WorldSerializer::Load(world, SNAPSHOT_PATH));
+    CheckLoaded(world);
+    
+    Entity entity = world.CreateEntity();
+    world.AddComponent(entity, Position{ -1.0f, 0.0f, 0.0f });
+    ORCHARD_CHECK(entity.id > 100 && entity.id <= 200 && entity.id != s_EmptyEntity);
+    
+    World populated;
+    populated.CreateEntity();
+    ORCHARD_CHECK(!WorldSerializer::Load(populated, SNAPSHOT_PATH));
+}
+
+void TestCorruptFileLeavesWorldEmpty() {
+    std::vector<char> bytes;
+    {
+        std::ifstream file(SNAPSHOT_PATH, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    ORCHARD_CHECK(bytes.size() > 2 * CHUNK_SIZE);
+    
+    EntityID duplicate = 1;
+    std::memcpy(bytes.data() + bytes.size() - CHUNK_SIZE, &duplicate, sizeof(duplicate));
+    const char* corruptPath = "ECSSerializationTests.corrupt.bin";
+    {
+        std::ofstream file(corruptPath, std::ios::binary | std::ios::trunc);
+        file.write(bytes.data(), bytes.size());
+    }
+    
+    World world;
+    ORCHARD_CHECK(!WorldSerializer::Load(world, corruptPath));
+    ORCHARD_CHECK(world.GetArchetypes().empty());
+    ORCHARD_CHECK(!world.IsEntityValid(Entity(1, 0)));
+    
+    ORCHARD_CHECK(WorldSerializer::Load(world, SNAPSHOT_PATH));
+    CheckLoaded(world);
+    std::remove(corruptPath);
+}
+
+void TestUnnamedComponentsAreNotSaved() {
+    const char* path = "ECSSerializationTests.unnamed.bin";
+    World world;
+    Entity entity = world.CreateEntity();
+    world.AddComponent(entity, Position{ 1.0f, 2.0f, 3.0f });
+    ORCHARD_CHECK(WorldSerializer::Save(world, path));
+    
+    world.AddComponent(entity, Unnamed{ 7 });
+    ORCHARD_CHECK(!WorldSerializer::Save(world, path));
+    std::remove(path);
+}
+
+void TestOversizedCountsAreRejected() {
+    constexpr size_t ARCHETYPE_COUNT_OFFSET = 20;
+    constexpr size_t NEXT_ENTITY_OFFSET = 32;
+    
+    std::vector<char> original;
+    {
+        std::ifstream file(SNAPSHOT_PATH, std::ios::binary);
+        original.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    
+    const char* corruptPath = "ECSSerializationTests.oversized.bin";
+    auto loadPatched = [&](size_t offset, const void* value, size_t size) {
+        std::vector<char> bytes = original;
+        std::memcpy(bytes.data() + offset, value, size);
+        {
+            std::ofstream file(corruptPath, std::ios::binary | std::ios::trunc);
+            file.write(bytes.data(), bytes.size());
+        }
+        World world;
+        bool loaded = WorldSerializer::Load(world, corruptPath);
+        ORCHARD_CHECK(world.GetArchetypes().empty());
+        return loaded;
+    };
+    
+    uint64_t nextEntityID = uint64_t(1) << 40;
+    ORCHARD_CHECK(!loadPatched(NEXT_ENTITY_OFFSET, &nextEntityID, sizeof(nextEntityID)));
+    uint32_t archetypeCount = ~uint32_t(0);
+    ORCHARD_CHECK(!loadPatched(ARCHETYPE_COUNT_OFFSET, &archetypeCount, sizeof(archetypeCount)));
+    std::remove(corruptPath);
+}
+
+}
+
+int main() {
+    PopulateAndSave();
+    TestRoundTrip();
+    TestCorruptFileLeavesWorldEmpty();
+    TestOversizedCountsAreRejected();
+    TestUnnamedComponentsAreNotSaved();
+    std::remove(SNAPSHOT_PATH);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,136 @@
+#include "TestCommon.hpp"
+#include "ECS/World.hpp"
+#include <string>
+#include <vector>
+
+using namespace Orchard::ECS;
+
+namespace {
+
+struct Material : SharedComponent {
+    static inline int s_Live = 0;
+    
+    std::string name;
+    
+    explicit Material(std::string value) : name(std::move(value)) { ++s_Live; }
+    Material(const Material& other) : name(other.name) { ++s_Live; }
+    Material(Material&& other) : name(std::move(other.name)) { ++s_Live; }
+    ~Material() { --s_Live; }
+    
+    bool operator==(const Material& other) const { return name == other.name; }
+};
+
+struct Tint : SharedComponent {
+    uint32_t rgba;
+    
+    bool operator==(const Tint& other) const { return rgba == other.rgba; }
+};
+
+struct Position { float x; };
+
+void TestCommandPayloadsAreDestroyed() {
+    World world;
+    Entity entity = world.CreateEntity();
+    
+    EntityCommandBuffer& buffer = world.GetCommandBuffer();
+    buffer.AddComponent(entity, Material(std::string(64, 'w')));
+    buffer.Clear();
+    ORCHARD_CHECK(Material::s_Live == 0);
+    
+    buffer.AddComponent(entity, Material(std::string(64, 's')));
+    buffer.AddComponent(entity, Material(std::string(64, 's')));
+    world.PlaybackCommands();
+    ORCHARD_CHECK(Material::s_Live == 1);
+    ORCHARD_CHECK(world.GetSharedComponent<Material>(entity)->name == std::string(64, 's'));
+}
+
+void TestUnusedValuesAreReleased() {
+    {
+        World world;
+        std::vector<Entity> entities;
+        for (int i = 0; i < 64; ++i) {
+            Entity entity = world.CreateEntity();
+            world.SetSharedComponent(entity, Material("material" + std::to_string(i % 8)));
+            entities.push_back(entity);
+        }
+        ORCHARD_CHECK(Material::s_Live == 8);
+        
+        for (size_t i = 0; i < entities.size(); ++i) {
+            if (i % 8 != 0) world.DestroyEntity(entities[i]);
+        }
+        ORCHARD_CHECK(world.Compact(1.0e6));
+        ORCHARD_CHECK(Material::s_Live == 1);
+        
+        Entity entity = world.CreateEntity();
+        world.SetSharedComponent(entity, Material("material3"));
+        world.AddComponent(entity, Position{ 1.0f });
+        ORCHARD_CHECK(Material::s_Live == 2);
+        ORCHARD_CHECK(world.GetSharedComponent<Material>(entity)->name == "material3");
+        ORCHARD_CHECK(world.GetSharedComponent<Material>(entities[0])->name == "material0");
+        
+        size_t visited = 0;
+        world.GetQuery<const Material>().ForEach([&](Entity, const Material&) { ++visited; });
+        ORCHARD_CHECK(visited == 9);
+    }
+    ORCHARD_CHECK(Material::s_Live == 0);
+}
+
+void TestSnapshotKeepsReleasedValues() {
+    World world;
+    Entity entity = world.CreateEntity();
+    world.AddComponent(entity, Position{ 2.0f });
+    world.SetSharedComponent(entity, Tint{ {}, 0xff00ff00u });
+    
+    auto snapshot = world.CaptureSnapshot();
+    world.DestroyEntity(entity);
+    ORCHARD_CHECK(world.Compact(1.0e6));
+    
+    Entity other = world.CreateEntity();
+    world.AddComponent(other, Position{ 3.0f });
+    world.SetSharedComponent(other, Tint{ {}, 0x0000ffffu });
+    
+    size_t visited = 0;
+    snapshot->ForEach<Position, Tint>([&](Entity, const Position& position, const Tint& tint) {
+        ORCHARD_CHECK(position.x == 2.0f);
+        ORCHARD_CHECK(tint.rgba == 0xff00ff00u);
+        ++visited;
+    });
+    ORCHARD_CHECK(visited == 1);
+    ORCHARD_CHECK(world.GetSharedComponent<Tint>(other)->rgba == 0x0000ffffu);
+}
+
+void TestPrefabsPinSharedArchetypes() {
+    {
+        World world;
+        Entity source = world.CreateEntity();
+        world.AddComponent(source, Position{ 4.0f });
+        world.SetSharedComponent(source, Material("prefab"));
+        PrefabID prefab = world.CreatePrefab({ source });
+        world.DestroyEntity(source);
+        
+        ORCHARD_CHECK(world.Compact(1.0e6));
+        ORCHARD_CHECK(Material::s_Live == 1);
+        
+        std::vector<Entity> instances = world.InstantiatePrefab(prefab, 3);
+        ORCHARD_CHECK(instances.size() == 3);
+        for (Entity instance : instances) {
+            ORCHARD_CHECK(world.GetSharedComponent<Material>(instance)->name == "prefab");
+        }
+        
+        world.DestroyEntities(instances);
+        world.DestroyPrefab(prefab);
+        ORCHARD_CHECK(world.Compact(1.0e6));
+        ORCHARD_CHECK(Material::s_Live == 0);
+    }
+    ORCHARD_CHECK(Material::s_Live == 0);
+}
+
+}
+
+int main() {
+    TestCommandPayloadsAreDestroyed();
+    TestUnusedValuesAreReleased();
+    TestSnapshotKeepsReleasedValues();
+    TestPrefabsPinSharedArchetypes();
+    return EXIT_SUCCESS;
+}
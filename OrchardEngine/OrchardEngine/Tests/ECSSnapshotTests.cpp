@@ -0,0 +1,100 @@
+#include "TestCommon.hpp"
+#include "ECS/World.hpp"
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Orchard::ECS;
+
+namespace {
+
+struct Position { float x; };
+struct Velocity { float x; };
+
+float SumPositions(const WorldSnapshot& snapshot) {
+    float sum = 0.0f;
+    snapshot.ForEach<Position>([&](Entity, const Position& position) { sum += position.x; });
+    return sum;
+}
+
+void TestUnchangedChunksAreShared() {
+    World world;
+    std::vector<Entity> entities;
+    for (int i = 0; i < 4000; ++i) {
+        Entity entity = world.CreateEntity();
+        world.AddComponent(entity, Position{ 1.0f });
+        if (i % 2) world.AddComponent(entity, Velocity{ 0.0f });
+        entities.push_back(entity);
+    }
+    
+    auto first = world.CaptureSnapshot();
+    ORCHARD_CHECK(first->GetSharedChunkCount() == 0);
+    ORCHARD_CHECK(first->GetEntityCount() == 4000);
+    size_t chunkCount = first->GetCopiedChunkCount();
+    ORCHARD_CHECK(chunkCount > 2);
+    
+    auto second = world.CaptureSnapshot();
+    ORCHARD_CHECK(second->GetSharedChunkCount() == chunkCount);
+    ORCHARD_CHECK(second->GetCopiedChunkCount() == 0);
+    
+    world.GetComponent<Position>(entities[0])->x = 5.0f;
+    auto third = world.CaptureSnapshot();
+    ORCHARD_CHECK(third->GetCopiedChunkCount() == 1);
+    ORCHARD_CHECK(third->GetSharedChunkCount() == chunkCount - 1);
+    
+    ORCHARD_CHECK(SumPositions(*first) == 4000.0f);
+    ORCHARD_CHECK(SumPositions(*second) == 4000.0f);
+    ORCHARD_CHECK(SumPositions(*third) == 4004.0f);
+}
+
+void TestSnapshotReadWhileWorldRuns() {
+    World world;
+    for (int i = 0; i < 4000; ++i) {
+        Entity entity = world.CreateEntity();
+        world.AddComponent(entity, Position{ 0.0f });
+        world.AddComponent(entity, Velocity{ 1.0f });
+    }
+    
+    for (int frame = 1; frame <= 20; ++frame) {
+        world.GetQuery<Position, const Velocity>().ForEach([](Entity, Position& position, const Velocity& velocity) {
+            position.x += velocity.x;
+        });
+        auto snapshot = world.CaptureSnapshot();
+        
+        float sum = 0.0f;
+        std::thread reader([&]() { sum = SumPositions(*snapshot); });
+        world.GetQuery<Position>().ForEach([](Entity, Position& position) { position.x = -1.0f; });
+        reader.join();
+        ORCHARD_CHECK(sum == 4000.0f * static_cast<float>(frame));
+        
+        world.GetQuery<Position>().ForEach([frame](Entity, Position& position) {
+            position.x = static_cast<float>(frame);
+        });
+    }
+}
+
+void TestSnapshotOutlivesWorld() {
+    std::shared_ptr<const WorldSnapshot> snapshot;
+    {
+        World world;
+        for (int i = 0; i < 3000; ++i) {
+            Entity entity = world.CreateEntity();
+            world.AddComponent(entity, Position{ 2.0f });
+        }
+        snapshot = world.CaptureSnapshot();
+        world.GetQuery<Position>().ForEach([](Entity, Position& position) { position.x = 0.0f; });
+    }
+    
+    ORCHARD_CHECK(snapshot->GetEntityCount() == 3000);
+    ORCHARD_CHECK(SumPositions(*snapshot) == 6000.0f);
+    snapshot.reset();
+}
+
+}
+
+int main() {
+    TestUnchangedChunksAreShared();
+    TestSnapshotReadWhileWorldRuns();
+    TestSnapshotOutlivesWorld();
+    return EXIT_SUCCESS;
+}
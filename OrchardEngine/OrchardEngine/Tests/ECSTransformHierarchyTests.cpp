@@ -0,0 +1,97 @@
+#include "TestCommon.hpp"
+#include "ECS/World.hpp"
+#include "ECS/Systems/TransformHierarchySystem.hpp"
+#include <memory>
+
+using namespace Orchard;
+using namespace Orchard::ECS;
+
+namespace {
+
+Entity CreateNode(World& world, float x) {
+    Entity entity = world.CreateEntity();
+    TransformComponent transform;
+    transform.SetPosition(Math::Vector3(x, 0.0f, 0.0f));
+    world.AddComponent(entity, transform);
+    world.AddComponent(entity, LocalToWorld{});
+    return entity;
+}
+
+float WorldX(const World& world, Entity entity) {
+    return world.GetComponent<LocalToWorld>(entity)->matrix.m[12];
+}
+
+void TestChildrenFollowParents() {
+    World world;
+    world.AddSystem(std::make_unique<TransformHierarchySystem>());
+    
+    Entity root = CreateNode(world, 1.0f);
+    Entity child = CreateNode(world, 2.0f);
+    Entity grandchild = CreateNode(world, 4.0f);
+    SetParent(world, grandchild, child);
+    SetParent(world, child, root);
+    world.Update(0.016);
+    
+    const World& view = world;
+    ORCHARD_CHECK(GetHierarchyDepth(view, child) == 1);
+    ORCHARD_CHECK(GetHierarchyDepth(view, grandchild) == 2);
+    ORCHARD_CHECK(WorldX(view, grandchild) == 7.0f);
+    
+    world.GetComponent<TransformComponent>(root)->SetPosition(Math::Vector3(10.0f, 0.0f, 0.0f));
+    world.Update(0.016);
+    ORCHARD_CHECK(WorldX(view, child) == 12.0f);
+    ORCHARD_CHECK(WorldX(view, grandchild) == 16.0f);
+}
+
+void TestRevivedDepthArchetypesAreRelevelled() {
+    World world;
+    world.AddSystem(std::make_unique<TransformHierarchySystem>());
+    
+    Entity root = CreateNode(world, 1.0f);
+    Entity child = CreateNode(world, 2.0f);
+    Entity grandchild = CreateNode(world, 4.0f);
+    SetParent(world, child, root);
+    SetParent(world, grandchild, child);
+    world.Update(0.016);
+    
+    world.DestroyEntity(grandchild);
+    world.DestroyEntity(child);
+    world.Update(0.016);
+    ORCHARD_CHECK(world.Compact(1.0e6));
+    
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        Entity first = CreateNode(world, 2.0f);
+        Entity second = CreateNode(world, 4.0f);
+        if (attempt == 0) {
+            SetParent(world, first, root);
+            SetParent(world, second, first);
+        } else {
+            SetParent(world, second, first);
+            SetParent(world, first, root);
+        }
+        world.Update(0.016);
+        
+        const World& view = world;
+        ORCHARD_CHECK(GetHierarchyDepth(view, second) == 2);
+        ORCHARD_CHECK(WorldX(view, second) == 7.0f);
+        
+        world.GetComponent<TransformComponent>(root)->SetPosition(Math::Vector3(10.0f, 0.0f, 0.0f));
+        world.Update(0.016);
+        ORCHARD_CHECK(WorldX(view, first) == 12.0f);
+        ORCHARD_CHECK(WorldX(view, second) == 16.0f);
+        
+        world.GetComponent<TransformComponent>(root)->SetPosition(Math::Vector3(1.0f, 0.0f, 0.0f));
+        world.DestroyEntity(second);
+        world.DestroyEntity(first);
+        world.Update(0.016);
+        ORCHARD_CHECK(world.Compact(1.0e6));
+    }
+}
+
+}
+
+int main() {
+    TestChildrenFollowParents();
+    TestRevivedDepthArchetypesAreRelevelled();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+#include "TestCommon.hpp"
+#include "ECS/World.hpp"
+#include <cmath>
+#include <memory>
+#include <vector>
+
+using namespace Orchard::ECS;
+
+namespace {
+
+constexpr uint32_t BUCKET_COUNT = 4;
+
+struct Age {
+    double time;
+    int runs;
+    int lastFrame;
+};
+
+struct Marker {};
+
+struct AgingSystem : System {
+    AgingSystem() {
+        Writes<Age>();
+        SetUpdateBuckets(BUCKET_COUNT);
+    }
+    
+    void OnUpdate(World* world, double deltaTime) override {
+        visited = 0;
+        world->GetQuery<Age>().ForEachInBucket(0, GetUpdateBuckets(), GetCurrentBucket(), [&](Entity, Age& age) {
+            if (age.runs > 0 && frame - age.lastFrame != static_cast<int>(BUCKET_COUNT)) skipped = true;
+            age.time += deltaTime;
+            age.lastFrame = frame;
+            ++age.runs;
+            ++visited;
+        });
+        ++frame;
+    }
+    
+    int frame = 0;
+    size_t visited = 0;
+    bool skipped = false;
+};
+
+struct ChangeFollower : System {
+    ChangeFollower() {
+        Reads<Age>();
+        SetUpdateBuckets(BUCKET_COUNT);
+    }
+    
+    void OnUpdate(World* world, double) override {
+        world->GetQuery<Changed<const Age>>().ForEachInBucket(GetLastBucketRunVersion(), GetUpdateBuckets(),
+                                                               GetCurrentBucket(), [&](Entity, const Age&) { ++seen; });
+    }
+    
+    size_t seen = 0;
+};
+
+double FrameTime(int frame) {
+    return 0.01 + 0.001 * (frame % 7);
+}
+
+std::vector<Entity> Populate(World& world, size_t count) {
+    std::vector<Entity> entities;
+    for (size_t i = 0; i < count; ++i) {
+        Entity entity = world.CreateEntity();
+        world.AddComponent(entity, Age{ 0.0, 0, 0 });
+        if (i % 100 == 0) world.AddComponent(entity, Marker{});
+        entities.push_back(entity);
+    }
+    return entities;
+}
+
+void TestEachEntityRunsOncePerCycle() {
+    World world;
+    std::vector<Entity> entities = Populate(world, 8000);
+    auto system = std::make_unique<AgingSystem>();
+    AgingSystem* aging = system.get();
+    world.AddSystem(std::move(system));
+    
+    constexpr int CYCLES = 25;
+    std::vector<double> elapsed;
+    double total = 0.0;
+    for (int frame = 0; frame < CYCLES * static_cast<int>(BUCKET_COUNT); ++frame) {
+        world.Update(FrameTime(frame));
+        total += FrameTime(frame);
+        elapsed.push_back(total);
+        ORCHARD_CHECK(aging->visited == entities.size() / BUCKET_COUNT);
+    }
+    ORCHARD_CHECK(!aging->skipped);
+    
+    const World& view = world;
+    for (Entity entity : entities) {
+        const Age* age = view.GetComponent<Age>(entity);
+        ORCHARD_CHECK(age->runs == CYCLES);
+        ORCHARD_CHECK(std::fabs(age->time - elapsed[age->lastFrame]) < 1.0e-9);
+    }
+}
+
+void TestCompactionKeepsBuckets() {
+    World world;
+    std::vector<Entity> entities = Populate(world, 8000);
+    auto system = std::make_unique<AgingSystem>();
+    AgingSystem* aging = system.get();
+    world.AddSystem(std::move(system));
+    
+    for (int frame = 0; frame < 6; ++frame) {
+        world.Update(0.01);
+    }
+    
+    std::vector<Entity> alive;
+    for (size_t i = 0; i < entities.size(); ++i) {
+        if (i % 3 == 0) {
+            world.DestroyEntity(entities[i]);
+        } else {
+            alive.push_back(entities[i]);
+        }
+    }
+    ORCHARD_CHECK(world.Compact(1.0e6));
+    
+    for (int frame = 6; frame < 6 + 3 * static_cast<int>(BUCKET_COUNT); ++frame) {
+        world.Update(0.01);
+    }
+    ORCHARD_CHECK(!aging->skipped);
+    
+    const World& view = world;
+    for (Entity entity : alive) {
+        ORCHARD_CHECK(view.GetComponent<Age>(entity)->runs == 4 + (entity.id % BUCKET_COUNT < 2 ? 1 : 0));
+    }
+}
+
+void TestBucketsTrackTheirOwnChanges() {
+    World world;
+    std::vector<Entity> entities = Populate(world, 8000);
+    auto system = std::make_unique<ChangeFollower>();
+    ChangeFollower* follower = system.get();
+    world.AddSystem(std::move(system));
+    
+    for (uint32_t frame = 0; frame < BUCKET_COUNT; ++frame) {
+        world.Update(0.01);
+    }
+    ORCHARD_CHECK(follower->seen == entities.size());
+    
+    follower->seen = 0;
+    for (uint32_t frame = 0; frame < BUCKET_COUNT; ++frame) {
+        world.Update(0.01);
+    }
+    ORCHARD_CHECK(follower->seen == 0);
+    
+    for (Entity entity : entities) {
+        world.GetComponent<Age>(entity)->time = 1.0;
+    }
+    for (uint32_t frame = 0; frame < BUCKET_COUNT; ++frame) {
+        world.Update(0.01);
+    }
+    ORCHARD_CHECK(follower->seen == entities.size());
+}
+
+}
+
+int main() {
+    TestEachEntityRunsOncePerCycle();
+    TestCompactionKeepsBuckets();
+    TestBucketsTrackTheirOwnChanges();
+    return EXIT_SUCCESS;
+}
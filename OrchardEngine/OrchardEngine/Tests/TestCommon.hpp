@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+
+#define ORCHARD_CHECK(condition)                                                              \
+    do {                                                                                      \
+        if (!(condition)) {                                                                   \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition << std::endl; \
+            std::exit(EXIT_FAILURE);                                                          \
+        }                                                                                     \
+    } while (false)